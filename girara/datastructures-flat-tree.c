@@ -0,0 +1,167 @@
+/* SPDX-License-Identifier: Zlib */
+
+#include "datastructures.h"
+
+#include <glib.h>
+
+#include "internal.h"
+
+/* The nodes are stored in pre-order as three parallel arrays, so that a scan
+ * over the data does not touch the structure and vice versa. */
+struct girara_flat_tree_s {
+  size_t size;                 /**> Number of nodes */
+  void** data;                 /**> Data of the nodes */
+  size_t* parent;              /**> Index of the parent of the nodes */
+  size_t* subtree_size;        /**> Number of nodes in the subtree of the nodes */
+  girara_free_function_t free; /**> The free function */
+  GBytes* backing;             /**> Memory the data may point into */
+};
+
+girara_flat_tree_t* flat_tree_new(size_t size, girara_free_function_t gfree) {
+  girara_flat_tree_t* tree = g_try_malloc0(sizeof(girara_flat_tree_t));
+  if (tree == NULL) {
+    return NULL;
+  }
+
+  /* one block for all three arrays */
+  void* block = g_try_malloc_n(MAX(size, 1), sizeof(void*) + 2 * sizeof(size_t));
+  if (block == NULL) {
+    g_free(tree);
+    return NULL;
+  }
+
+  tree->size         = size;
+  tree->data         = block;
+  tree->parent       = (size_t*)(tree->data + size);
+  tree->subtree_size = tree->parent + size;
+  tree->free         = gfree;
+
+  return tree;
+}
+
+void flat_tree_set_node(girara_flat_tree_t* tree, size_t index, void* data, size_t parent) {
+  tree->data[index]         = data;
+  tree->parent[index]       = parent;
+  tree->subtree_size[index] = 1;
+}
+
+void flat_tree_set_backing(girara_flat_tree_t* tree, GBytes* bytes) {
+  g_clear_pointer(&tree->backing, g_bytes_unref);
+  tree->backing = g_bytes_ref(bytes);
+}
+
+void flat_tree_finish(girara_flat_tree_t* tree) {
+  /* children follow their parents, so a reverse scan sees complete subtrees */
+  for (size_t idx = tree->size; idx > 1; --idx) {
+    tree->subtree_size[tree->parent[idx - 1]] += tree->subtree_size[idx - 1];
+  }
+}
+
+static void flat_tree_freeze_visit(girara_tree_node_t* node, size_t index, size_t parent, void* userdata) {
+  flat_tree_set_node(userdata, index, girara_node_get_data(node), parent);
+  /* the data is owned by the flat tree now */
+  girara_node_set_free_function(node, NULL);
+}
+
+girara_flat_tree_t* girara_node_freeze(girara_tree_node_t* root) {
+  g_return_val_if_fail(root != NULL, NULL);
+
+  const girara_free_function_t gfree = node_get_free_function(root);
+  const size_t root_depth            = girara_node_get_depth(root);
+
+  size_t size      = 0;
+  size_t max_depth = 0;
+  {
+    g_auto(girara_node_iter_t) iter;
+    girara_node_iter_init(&iter, root, GIRARA_NODE_PRE_ORDER);
+    girara_tree_node_t* node = NULL;
+    while ((node = girara_node_iter_next(&iter)) != NULL) {
+      /* the flat tree can only take over data that is freed the same way */
+      g_return_val_if_fail(node_get_free_function(node) == gfree, NULL);
+      max_depth = MAX(max_depth, girara_node_get_depth(node) - root_depth);
+      ++size;
+    }
+  }
+
+  girara_flat_tree_t* tree = flat_tree_new(size, gfree);
+  if (tree == NULL) {
+    return NULL;
+  }
+
+  if (node_walk_flat(root, max_depth, flat_tree_freeze_visit, tree) == false) {
+    tree->free = NULL;
+    girara_flat_tree_free(tree);
+    return NULL;
+  }
+
+  flat_tree_finish(tree);
+  return tree;
+}
+
+void girara_flat_tree_free(girara_flat_tree_t* tree) {
+  if (tree == NULL) {
+    return;
+  }
+
+  if (tree->free != NULL) {
+    for (size_t idx = 0; idx != tree->size; ++idx) {
+      tree->free(tree->data[idx]);
+    }
+  }
+
+  g_free(tree->data);
+  if (tree->backing != NULL) {
+    g_bytes_unref(tree->backing);
+  }
+  g_free(tree);
+}
+
+size_t girara_flat_tree_size(const girara_flat_tree_t* tree) {
+  g_return_val_if_fail(tree != NULL, 0);
+  return tree->size;
+}
+
+void* girara_flat_tree_get_data(const girara_flat_tree_t* tree, size_t index) {
+  g_return_val_if_fail(tree != NULL && index < tree->size, NULL);
+  return tree->data[index];
+}
+
+size_t girara_flat_tree_get_parent(const girara_flat_tree_t* tree, size_t index) {
+  g_return_val_if_fail(tree != NULL && index < tree->size, GIRARA_FLAT_TREE_NONE);
+  return tree->parent[index];
+}
+
+size_t girara_flat_tree_get_first_child(const girara_flat_tree_t* tree, size_t index) {
+  g_return_val_if_fail(tree != NULL && index < tree->size, GIRARA_FLAT_TREE_NONE);
+  return tree->subtree_size[index] > 1 ? index + 1 : GIRARA_FLAT_TREE_NONE;
+}
+
+size_t girara_flat_tree_get_next_sibling(const girara_flat_tree_t* tree, size_t index) {
+  g_return_val_if_fail(tree != NULL && index < tree->size, GIRARA_FLAT_TREE_NONE);
+
+  const size_t parent = tree->parent[index];
+  if (parent == GIRARA_FLAT_TREE_NONE) {
+    return GIRARA_FLAT_TREE_NONE;
+  }
+
+  const size_t next = index + tree->subtree_size[index];
+  return next < parent + tree->subtree_size[parent] ? next : GIRARA_FLAT_TREE_NONE;
+}
+
+size_t girara_flat_tree_get_subtree_size(const girara_flat_tree_t* tree, size_t index) {
+  g_return_val_if_fail(tree != NULL && index < tree->size, 0);
+  return tree->subtree_size[index];
+}
+
+size_t girara_flat_tree_skip_subtree(const girara_flat_tree_t* tree, size_t index) {
+  g_return_val_if_fail(tree != NULL && index < tree->size, GIRARA_FLAT_TREE_NONE);
+  return index + tree->subtree_size[index];
+}
+
+void girara_flat_tree_foreach(const girara_flat_tree_t* tree, girara_list_callback_t callback, void* userdata) {
+  g_return_if_fail(tree != NULL && callback != NULL);
+
+  for (size_t idx = 0; idx != tree->size; ++idx) {
+    callback(tree->data[idx], userdata);
+  }
+}
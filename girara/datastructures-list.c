@@ -10,6 +10,9 @@
 struct girara_list_s {
   void** start;                  /**> List start */
   size_t size;                   /**> The list size */
+  size_t capacity;               /**> Number of allocated slots */
+  size_t max_retained;           /**> Maximal capacity kept by reset, 0 for no limit */
+  size_t high_water_mark;        /**> Largest size the list ever had */
   girara_free_function_t free;   /**> The free function **/
   girara_compare_function_t cmp; /**> The sort function */
 };
@@ -19,6 +22,32 @@ struct girara_list_iterator_s {
   size_t index;        /**> The list index */
 };
 
+static bool list_reserve(girara_list_t* list, size_t size) {
+  if (size <= list->capacity) {
+    return true;
+  }
+
+  size_t capacity = list->capacity != 0 ? list->capacity : 4;
+  while (capacity < size) {
+    capacity *= 2;
+  }
+
+  void** new_start = g_try_realloc_n(list->start, capacity, sizeof(void*));
+  if (new_start == NULL) {
+    return false;
+  }
+
+  list->start    = new_start;
+  list->capacity = capacity;
+  return true;
+}
+
+static void list_update_high_water_mark(girara_list_t* list) {
+  if (list->size > list->high_water_mark) {
+    list->high_water_mark = list->size;
+  }
+}
+
 girara_list_t* girara_list_new(void) {
   return g_try_malloc0(sizeof(girara_list_t));
 }
@@ -53,19 +82,54 @@ void girara_list_set_free_function(girara_list_t* list, girara_free_function_t g
   list->free = gfree;
 }
 
-void girara_list_clear(girara_list_t* list) {
-  if (list == NULL) {
-    return;
-  }
-
+static void list_free_elements(girara_list_t* list) {
   if (list->free) {
     for (size_t idx = 0; idx != list->size; ++idx) {
       list->free(list->start[idx]);
     }
   }
+  list->size = 0;
+}
+
+void girara_list_clear(girara_list_t* list) {
+  if (list == NULL) {
+    return;
+  }
+
+  list_free_elements(list);
   g_free(list->start);
-  list->start = NULL;
-  list->size  = 0;
+  list->start    = NULL;
+  list->capacity = 0;
+}
+
+void girara_list_reset(girara_list_t* list) {
+  g_return_if_fail(list != NULL);
+
+  list_free_elements(list);
+  if (list->max_retained == 0 || list->capacity <= list->max_retained) {
+    return;
+  }
+
+  void** new_start = g_try_realloc_n(list->start, list->max_retained, sizeof(void*));
+  if (new_start != NULL) {
+    list->start    = new_start;
+    list->capacity = list->max_retained;
+  }
+}
+
+void girara_list_set_max_retained_capacity(girara_list_t* list, size_t capacity) {
+  g_return_if_fail(list != NULL);
+  list->max_retained = capacity;
+}
+
+size_t girara_list_high_water_mark(girara_list_t* list) {
+  g_return_val_if_fail(list != NULL, 0);
+  return list->high_water_mark;
+}
+
+size_t girara_list_capacity(girara_list_t* list) {
+  g_return_val_if_fail(list != NULL, 0);
+  return list->capacity;
 }
 
 void girara_list_free(girara_list_t* list) {
@@ -77,12 +141,11 @@ void girara_list_free(girara_list_t* list) {
 
 void girara_list_append(girara_list_t* list, void* data) {
   g_return_if_fail(list != NULL);
+  const bool reserved = list_reserve(list, list->size + 1);
+  g_return_if_fail(reserved);
 
-  void** new_start = g_realloc_n(list->start, list->size + 1, sizeof(void*));
-  g_return_if_fail(new_start != NULL);
-
-  list->start               = new_start;
   list->start[list->size++] = data;
+  list_update_high_water_mark(list);
   if (list->cmp != NULL) {
     girara_list_sort(list, list->cmp);
   }
@@ -94,10 +157,13 @@ void girara_list_prepend(girara_list_t* list, void* data) {
   if (list->cmp != NULL) {
     girara_list_append(list, data);
   } else {
-    list->start = g_realloc_n(list->start, list->size + 1, sizeof(void*));
+    const bool reserved = list_reserve(list, list->size + 1);
+    g_return_if_fail(reserved);
+
     memmove(list->start + 1, list->start, list->size * sizeof(void*));
     list->start[0] = data;
     ++list->size;
+    list_update_high_water_mark(list);
   }
 }
 
@@ -157,6 +223,120 @@ void* girara_list_find(const girara_list_t* list, girara_compare_function_t comp
   return NULL;
 }
 
+/* Index of the first element that does not compare less than data. */
+static size_t list_lower_bound(const girara_list_t* list, girara_compare_function_t compare, const void* data) {
+  size_t lo = 0;
+  size_t hi = list->size;
+  while (lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (compare(list->start[mid], data) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+static size_t find_many_sorted(const girara_list_t* list, girara_compare_function_t compare, const void* const* keys,
+                               size_t n_keys, void** results) {
+  bool keys_sorted = true;
+  for (size_t idx = 1; idx < n_keys && keys_sorted == true; ++idx) {
+    keys_sorted = compare(keys[idx - 1], keys[idx]) <= 0;
+  }
+
+  size_t found = 0;
+  if (keys_sorted == true && n_keys * g_bit_storage(list->size) > list->size) {
+    /* merge both sequences */
+    size_t pos = 0;
+    for (size_t idx = 0; idx != n_keys; ++idx) {
+      while (pos < list->size && compare(list->start[pos], keys[idx]) < 0) {
+        ++pos;
+      }
+      results[idx] = NULL;
+      if (pos < list->size && compare(list->start[pos], keys[idx]) == 0) {
+        results[idx] = list->start[pos];
+        ++found;
+      }
+    }
+  } else {
+    /* binary search for every key */
+    for (size_t idx = 0; idx != n_keys; ++idx) {
+      const size_t pos = list_lower_bound(list, compare, keys[idx]);
+      results[idx]     = NULL;
+      if (pos < list->size && compare(list->start[pos], keys[idx]) == 0) {
+        results[idx] = list->start[pos];
+        ++found;
+      }
+    }
+  }
+
+  return found;
+}
+
+static size_t find_many_scan(const girara_list_t* list, girara_compare_function_t compare, const void* const* keys,
+                             size_t n_keys, void** results) {
+  size_t found = 0;
+  for (size_t idx = 0; idx != n_keys; ++idx) {
+    results[idx] = girara_list_find(list, compare, keys[idx]);
+    if (results[idx] != NULL) {
+      ++found;
+    }
+  }
+
+  return found;
+}
+
+static size_t find_many_hashed(const girara_list_t* list, girara_compare_function_t compare, GHashFunc hash,
+                               GHashFunc key_hash, const void* const* keys, size_t n_keys, void** results) {
+  /* keys with the same hash are chained through next, heads are stored as index + 1 */
+  size_t* next = g_try_malloc_n(n_keys, sizeof(size_t));
+  if (next == NULL) {
+    return find_many_scan(list, compare, keys, n_keys, results);
+  }
+
+  GHashTable* heads = g_hash_table_new(g_direct_hash, NULL);
+  for (size_t idx = n_keys; idx != 0; --idx) {
+    void* hashed  = GUINT_TO_POINTER(key_hash(keys[idx - 1]));
+    next[idx - 1] = GPOINTER_TO_SIZE(g_hash_table_lookup(heads, hashed));
+    g_hash_table_insert(heads, hashed, GSIZE_TO_POINTER(idx));
+    results[idx - 1] = NULL;
+  }
+
+  /* single pass over the list, looking up every element among the keys */
+  size_t found = 0;
+  for (size_t pos = 0; pos != list->size && found != n_keys; ++pos) {
+    void* element = list->start[pos];
+
+    size_t head = GPOINTER_TO_SIZE(g_hash_table_lookup(heads, GUINT_TO_POINTER(hash(element))));
+    for (; head != 0; head = next[head - 1]) {
+      if (results[head - 1] == NULL && compare(element, keys[head - 1]) == 0) {
+        results[head - 1] = element;
+        ++found;
+      }
+    }
+  }
+
+  g_hash_table_unref(heads);
+  g_free(next);
+  return found;
+}
+
+size_t girara_list_find_many(const girara_list_t* list, girara_compare_function_t compare, GHashFunc hash,
+                             GHashFunc key_hash, const void* const* keys, size_t n_keys, void** results) {
+  g_return_val_if_fail(list != NULL && compare != NULL, 0);
+  g_return_val_if_fail(n_keys == 0 || (keys != NULL && results != NULL), 0);
+
+  if (list->cmp == compare) {
+    return find_many_sorted(list, compare, keys, n_keys, results);
+  }
+  if (hash != NULL) {
+    return find_many_hashed(list, compare, hash, key_hash != NULL ? key_hash : hash, keys, n_keys, results);
+  }
+  return find_many_scan(list, compare, keys, n_keys, results);
+}
+
 girara_list_iterator_t* girara_list_iterator(girara_list_t* list) {
   g_return_val_if_fail(list != NULL, NULL);
 
@@ -286,6 +466,155 @@ void girara_list_sort(girara_list_t* list, girara_compare_function_t compare) {
   g_sort_array(list->start, list->size, sizeof(void*), comparer, &comp);
 }
 
+static void list_swap(void** lhs, void** rhs) {
+  void* tmp = *lhs;
+  *lhs      = *rhs;
+  *rhs      = tmp;
+}
+
+static void heap_sift_down(void** heap, size_t size, size_t idx, girara_compare_function_t compare) {
+  for (;;) {
+    const size_t left  = 2 * idx + 1;
+    const size_t right = left + 1;
+    size_t largest     = idx;
+
+    if (left < size && compare(heap[left], heap[largest]) > 0) {
+      largest = left;
+    }
+    if (right < size && compare(heap[right], heap[largest]) > 0) {
+      largest = right;
+    }
+    if (largest == idx) {
+      return;
+    }
+
+    list_swap(&heap[idx], &heap[largest]);
+    idx = largest;
+  }
+}
+
+/* Move the k smallest elements to the front, arranged as a max-heap. */
+static void heap_select(void** elements, size_t size, size_t k, girara_compare_function_t compare) {
+  for (size_t idx = k / 2; idx-- > 0;) {
+    heap_sift_down(elements, k, idx, compare);
+  }
+
+  for (size_t idx = k; idx < size; ++idx) {
+    if (compare(elements[idx], elements[0]) < 0) {
+      list_swap(&elements[idx], &elements[0]);
+      heap_sift_down(elements, k, 0, compare);
+    }
+  }
+}
+
+static void heap_sort(void** heap, size_t size, girara_compare_function_t compare) {
+  for (size_t end = size; end > 1; --end) {
+    list_swap(&heap[0], &heap[end - 1]);
+    heap_sift_down(heap, end - 1, 0, compare);
+  }
+}
+
+static size_t list_partition(void** elements, size_t lo, size_t hi, girara_compare_function_t compare) {
+  /* median of three as pivot, stored at lo */
+  const size_t mid = lo + (hi - lo) / 2;
+  if (compare(elements[mid], elements[lo]) < 0) {
+    list_swap(&elements[mid], &elements[lo]);
+  }
+  if (compare(elements[hi - 1], elements[mid]) < 0) {
+    list_swap(&elements[hi - 1], &elements[mid]);
+    if (compare(elements[mid], elements[lo]) < 0) {
+      list_swap(&elements[mid], &elements[lo]);
+    }
+  }
+  list_swap(&elements[lo], &elements[mid]);
+
+  void* pivot = elements[lo];
+  size_t i    = lo;
+  size_t j    = hi;
+  for (;;) {
+    do {
+      ++i;
+    } while (i < hi && compare(elements[i], pivot) < 0);
+    do {
+      --j;
+    } while (compare(elements[j], pivot) > 0);
+
+    if (i >= j) {
+      break;
+    }
+    list_swap(&elements[i], &elements[j]);
+  }
+  list_swap(&elements[lo], &elements[j]);
+
+  return j;
+}
+
+static void introselect(void** elements, size_t size, size_t nth, girara_compare_function_t compare) {
+  size_t lo    = 0;
+  size_t hi    = size;
+  size_t depth = 2 * g_bit_storage(size);
+
+  while (hi - lo > 16) {
+    if (depth-- == 0) {
+      /* too many bad pivots: fall back to heap selection */
+      heap_select(elements + lo, hi - lo, nth - lo + 1, compare);
+      list_swap(&elements[lo], &elements[nth]);
+      return;
+    }
+
+    const size_t pivot = list_partition(elements, lo, hi, compare);
+    if (pivot == nth) {
+      return;
+    } else if (nth < pivot) {
+      hi = pivot;
+    } else {
+      lo = pivot + 1;
+    }
+  }
+
+  /* insertion sort for the remaining small range */
+  for (size_t idx = lo + 1; idx < hi; ++idx) {
+    for (size_t pos = idx; pos > lo && compare(elements[pos], elements[pos - 1]) < 0; --pos) {
+      list_swap(&elements[pos], &elements[pos - 1]);
+    }
+  }
+}
+
+void girara_list_partial_sort(girara_list_t* list, size_t k, girara_compare_function_t compare) {
+  g_return_if_fail(list != NULL);
+  if (list->start == NULL || compare == NULL || list->cmp == compare) {
+    return;
+  }
+  g_return_if_fail(list->cmp == NULL);
+
+  if (k > list->size) {
+    k = list->size;
+  }
+  if (k == 0) {
+    return;
+  }
+
+  if (k >= list->size / 2) {
+    girara_list_sort(list, compare);
+    return;
+  }
+
+  heap_select(list->start, list->size, k, compare);
+  heap_sort(list->start, k, compare);
+}
+
+void* girara_list_select_nth(girara_list_t* list, size_t n, girara_compare_function_t compare) {
+  g_return_val_if_fail(list != NULL && compare != NULL, NULL);
+  g_return_val_if_fail(n < list->size, NULL);
+  g_return_val_if_fail(list->cmp == NULL || list->cmp == compare, NULL);
+
+  if (list->cmp == NULL) {
+    introselect(list->start, list->size, n, compare);
+  }
+
+  return list->start[n];
+}
+
 void girara_list_foreach(girara_list_t* list, girara_list_callback_t callback, void* data) {
   g_return_if_fail(list != NULL && callback != NULL);
   if (list->start == NULL) {
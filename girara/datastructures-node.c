@@ -3,28 +3,172 @@
 #include "datastructures.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <glib.h>
 
+#include "internal.h"
+
 struct girara_tree_node_s {
-  GNode* node;                 /**> The node object */
-  girara_free_function_t free; /**> The free function */
-  void* data;                  /**> The data */
+  girara_tree_node_t* parent;     /**> The parent node */
+  girara_tree_node_t* children;   /**> The first child */
+  girara_tree_node_t* last_child; /**> The last child */
+  girara_tree_node_t* next;       /**> The next sibling */
+  girara_tree_node_t* prev;       /**> The previous sibling */
+  girara_tree_node_t* root;       /**> The root of the tree */
+  size_t n_children;              /**> Number of children */
+  size_t depth;                   /**> Distance to the root */
+  girara_tree_pool_t* pool;       /**> The pool the node was allocated from */
+  struct node_keys_s* keys;       /**> Key functions of the tree, only used on the root */
+  GHashTable* index;              /**> Index of the children by key */
+  bool index_dirty;               /**> The index needs to be rebuilt */
+  girara_free_function_t free;    /**> The free function */
+  void* data;                     /**> The data */
 };
 
+typedef struct node_keys_s {
+  GHashFunc hash;   /**> Hash function for the data */
+  GEqualFunc equal; /**> Equality function for the data */
+} node_keys_t;
+
+/* Children are indexed once a node has this many of them. */
+#define NODE_INDEX_THRESHOLD 16
+
+#define TREE_POOL_MIN_SLAB_SIZE 64
+#define TREE_POOL_MAX_SLAB_SIZE 65536
+
+typedef struct tree_pool_slab_s {
+  struct tree_pool_slab_s* next; /**> The next slab */
+  size_t size;                   /**> Number of nodes in the slab */
+  size_t used;                   /**> Number of nodes handed out */
+  girara_tree_node_t nodes[];    /**> The nodes */
+} tree_pool_slab_t;
+
+struct girara_tree_pool_s {
+  tree_pool_slab_t* slabs;        /**> Allocated slabs, newest first */
+  girara_tree_node_t* free_nodes; /**> Released nodes, linked via next */
+  size_t live;                    /**> Number of nodes in use */
+  bool orphaned;                  /**> The pool is freed with its last node */
+};
+
+girara_tree_pool_t* girara_tree_pool_new(void) {
+  return g_try_malloc0(sizeof(girara_tree_pool_t));
+}
+
+static void tree_pool_release_slabs(girara_tree_pool_t* pool) {
+  tree_pool_slab_t* slab = pool->slabs;
+  while (slab != NULL) {
+    tree_pool_slab_t* next = slab->next;
+    g_free(slab);
+    slab = next;
+  }
+
+  pool->slabs      = NULL;
+  pool->free_nodes = NULL;
+}
+
+void girara_tree_pool_free(girara_tree_pool_t* pool) {
+  if (pool == NULL) {
+    return;
+  }
+
+  if (pool->live != 0) {
+    pool->orphaned = true;
+    return;
+  }
+
+  tree_pool_release_slabs(pool);
+  g_free(pool);
+}
+
+static tree_pool_slab_t* tree_pool_add_slab(girara_tree_pool_t* pool, size_t size) {
+  if (size > (G_MAXSIZE - sizeof(tree_pool_slab_t)) / sizeof(girara_tree_node_t)) {
+    return NULL;
+  }
+
+  tree_pool_slab_t* slab = g_try_malloc(sizeof(tree_pool_slab_t) + size * sizeof(girara_tree_node_t));
+  if (slab == NULL) {
+    return NULL;
+  }
+
+  slab->next  = pool->slabs;
+  slab->size  = size;
+  slab->used  = 0;
+  pool->slabs = slab;
+
+  return slab;
+}
+
+static girara_tree_node_t* tree_pool_alloc(girara_tree_pool_t* pool) {
+  girara_tree_node_t* node = pool->free_nodes;
+  if (node != NULL) {
+    pool->free_nodes = node->next;
+  } else {
+    tree_pool_slab_t* slab = pool->slabs;
+    if (slab == NULL || slab->used == slab->size) {
+      slab = tree_pool_add_slab(
+          pool, slab != NULL ? MIN(slab->size * 2, TREE_POOL_MAX_SLAB_SIZE) : TREE_POOL_MIN_SLAB_SIZE);
+      if (slab == NULL) {
+        return NULL;
+      }
+    }
+    node = &slab->nodes[slab->used++];
+  }
+
+  memset(node, 0, sizeof(girara_tree_node_t));
+  node->root = node;
+  node->pool = pool;
+  ++pool->live;
+
+  return node;
+}
+
+static void node_release(girara_tree_node_t* node) {
+  if (node->index != NULL) {
+    g_hash_table_destroy(node->index);
+  }
+  g_free(node->keys);
+
+  girara_tree_pool_t* pool = node->pool;
+  if (pool == NULL) {
+    g_free(node);
+    return;
+  }
+
+  node->next       = pool->free_nodes;
+  pool->free_nodes = node;
+  if (--pool->live == 0) {
+    /* the last node is gone, so whole slabs can be released at once */
+    tree_pool_release_slabs(pool);
+    if (pool->orphaned == true) {
+      g_free(pool);
+    }
+  }
+}
+
 girara_tree_node_t* girara_node_new(void* data) {
   girara_tree_node_t* node = g_try_malloc0(sizeof(girara_tree_node_t));
   if (node == NULL) {
     return NULL;
   }
 
+  node->root = node;
   node->data = data;
-  node->node = g_node_new(node);
 
-  if (node->node == NULL) {
-    g_free(node);
+  return node;
+}
+
+girara_tree_node_t* girara_node_new_in_pool(girara_tree_pool_t* pool, void* data) {
+  if (pool == NULL) {
+    return girara_node_new(data);
+  }
+
+  girara_tree_node_t* node = tree_pool_alloc(pool);
+  if (node == NULL) {
     return NULL;
   }
 
+  node->data = data;
+
   return node;
 }
 
@@ -33,35 +177,552 @@ void girara_node_set_free_function(girara_tree_node_t* node, girara_free_functio
   node->free = gfree;
 }
 
-void girara_node_free(girara_tree_node_t* node) {
-  if (node == NULL) {
+girara_free_function_t node_get_free_function(girara_tree_node_t* node) {
+  return node->free;
+}
+
+size_t node_memory_usage(girara_tree_node_t* node) {
+  size_t usage = sizeof(girara_tree_node_t);
+  if (node->index != NULL) {
+    /* a hash, a key and a value per entry */
+    usage += g_hash_table_size(node->index) * (sizeof(guint) + 2 * sizeof(void*));
+  }
+
+  return usage;
+}
+
+static void node_index_remove(girara_tree_node_t* parent, girara_tree_node_t* child) {
+  if (parent->index != NULL && parent->index_dirty == false &&
+      g_hash_table_lookup(parent->index, child->data) == child) {
+    /* another child with the same key may need to take its place */
+    parent->index_dirty = true;
+  }
+}
+
+static void node_index_insert(girara_tree_node_t* parent, girara_tree_node_t* child) {
+  if (parent->index == NULL || parent->index_dirty == true) {
+    return;
+  }
+
+  if (g_hash_table_contains(parent->index, child->data) == FALSE) {
+    g_hash_table_insert(parent->index, child->data, child);
+  } else if (child->next != NULL) {
+    /* the new child might precede the indexed one */
+    parent->index_dirty = true;
+  }
+}
+
+/* Point the index entry of a child at a replacement, possibly with a new key. */
+static void node_index_replace(girara_tree_node_t* parent, girara_tree_node_t* child, const void* key,
+                               girara_tree_node_t* replacement, void* new_key) {
+  if (parent->index == NULL || parent->index_dirty == true) {
+    return;
+  }
+
+  const node_keys_t* keys = parent->root->keys;
+  GEqualFunc equal        = keys != NULL ? keys->equal : g_direct_equal;
+  if (g_hash_table_lookup(parent->index, key) == child && equal(new_key, key)) {
+    g_hash_table_steal(parent->index, key);
+    g_hash_table_insert(parent->index, new_key, replacement);
+  } else if (g_hash_table_lookup(parent->index, key) == child || g_hash_table_contains(parent->index, new_key)) {
+    /* the order among children with equal keys is unknown */
+    parent->index_dirty = true;
+  } else {
+    g_hash_table_insert(parent->index, new_key, replacement);
+  }
+}
+
+static void node_index_clear(girara_tree_node_t* node) {
+  if (node->index != NULL) {
+    g_hash_table_destroy(node->index);
+    node->index = NULL;
+  }
+}
+
+static void node_unlink(girara_tree_node_t* node) {
+  girara_tree_node_t* parent = node->parent;
+  if (parent == NULL) {
+    return;
+  }
+
+  node_index_remove(parent, node);
+
+  if (node->prev != NULL) {
+    node->prev->next = node->next;
+  } else {
+    parent->children = node->next;
+  }
+  if (node->next != NULL) {
+    node->next->prev = node->prev;
+  } else {
+    parent->last_child = node->prev;
+  }
+
+  --parent->n_children;
+  node->parent = NULL;
+  node->next   = NULL;
+  node->prev   = NULL;
+}
+
+static bool node_keys_equal(const node_keys_t* lhs, const node_keys_t* rhs) {
+  if (lhs == NULL || rhs == NULL) {
+    return lhs == rhs;
+  }
+
+  return lhs->hash == rhs->hash && lhs->equal == rhs->equal;
+}
+
+/* Update cached root and depth of all nodes in the subtree. */
+static void node_update_subtree(girara_tree_node_t* subtree, girara_tree_node_t* root, size_t depth) {
+  if (subtree->root == root && subtree->depth == depth) {
     return;
   }
 
+  /* indexes built with different key functions are useless in the new tree */
+  const bool rekey = node_keys_equal(subtree->root->keys, root->keys) == false;
+
+  girara_tree_node_t* node = subtree;
+  node->root               = root;
+  node->depth              = depth;
+  if (rekey == true) {
+    node_index_clear(node);
+  }
+  for (;;) {
+    if (node->children != NULL) {
+      node = node->children;
+    } else {
+      while (node != subtree && node->next == NULL) {
+        node = node->parent;
+      }
+      if (node == subtree) {
+        return;
+      }
+      node = node->next;
+    }
+
+    node->root  = root;
+    node->depth = node->parent->depth + 1;
+    if (rekey == true) {
+      node_index_clear(node);
+    }
+  }
+}
+
+static void node_free_data(girara_tree_node_t* node) {
   if (node->free != NULL) {
     node->free(node->data);
   }
+}
+
+/* Free a subtree without recursion: the data is freed in pre-order while
+ * descending, nodes are detached and released on the way back up. If deferred
+ * is set, pooled nodes are collected there instead of being released. */
+static void node_free_subtree(girara_tree_node_t* subtree, girara_tree_node_t** deferred) {
+  node_free_data(subtree);
+
+  girara_tree_node_t* node = subtree;
+  for (;;) {
+    girara_tree_node_t* child = node->children;
+    if (child != NULL) {
+      node_free_data(child);
+      node = child;
+      continue;
+    }
 
-  GNode* childnode = node->node->children;
-  while (childnode != NULL) {
-    GNode* nextnode                   = childnode->next;
-    girara_tree_node_t* childnodedata = childnode->data;
-    girara_node_free(childnodedata);
-    childnode = nextnode;
+    girara_tree_node_t* parent = node != subtree ? node->parent : NULL;
+    if (parent != NULL) {
+      parent->children = node->next;
+    }
+
+    if (deferred != NULL && node->pool != NULL) {
+      node->next = *deferred;
+      *deferred  = node;
+    } else {
+      node_release(node);
+    }
+
+    if (parent == NULL) {
+      return;
+    }
+    node = parent;
+  }
+}
+
+void girara_node_free(girara_tree_node_t* node) {
+  if (node == NULL) {
+    return;
   }
 
-  g_node_destroy(node->node);
-  g_free(node);
+  node_unlink(node);
+  node_free_subtree(node, NULL);
+}
+
+#define NODE_FREE_TASKS_PER_THREAD 4
+#define NODE_FREE_MAX_SPLIT_LEVELS 64
+
+typedef struct {
+  girara_list_t* subtrees;       /**> Independent subtrees */
+  size_t begin;                  /**> First subtree of the task */
+  size_t end;                    /**> End of the subtrees of the task */
+  girara_tree_node_t* deferred;  /**> Pooled nodes to be released */
+} node_free_task_t;
+
+static void node_free_task(void* data, void* GIRARA_UNUSED(userdata)) {
+  node_free_task_t* task = data;
+  for (size_t idx = task->begin; idx != task->end; ++idx) {
+    node_free_subtree(girara_list_nth(task->subtrees, idx), &task->deferred);
+  }
+}
+
+void girara_node_free_parallel(girara_tree_node_t* node, unsigned int n_threads) {
+  if (node == NULL) {
+    return;
+  }
+
+  if (n_threads == 0) {
+    n_threads = g_get_num_processors();
+  }
+
+  node_unlink(node);
+  if (n_threads <= 1 || node->n_children == 0) {
+    node_free_subtree(node, NULL);
+    return;
+  }
+
+  /* Split off the top of the tree until there are enough independent
+   * subtrees. The split nodes are released after all subtrees are gone. */
+  g_autoptr(girara_list_t) top      = girara_list_new();
+  g_autoptr(girara_list_t) subtrees = girara_list_new();
+  girara_list_append(subtrees, node);
+
+  const size_t target = n_threads * NODE_FREE_TASKS_PER_THREAD;
+  for (size_t level = 0; girara_list_size(subtrees) < target && level != NODE_FREE_MAX_SPLIT_LEVELS; ++level) {
+    girara_list_t* next = girara_list_new();
+    bool split          = false;
+    for (size_t idx = 0; idx != girara_list_size(subtrees); ++idx) {
+      girara_tree_node_t* subtree = girara_list_nth(subtrees, idx);
+      if (subtree->children == NULL) {
+        girara_list_append(next, subtree);
+        continue;
+      }
+
+      node_free_data(subtree);
+      girara_list_append(top, subtree);
+      for (girara_tree_node_t* child = subtree->children; child != NULL; child = child->next) {
+        girara_list_append(next, child);
+      }
+      split = true;
+    }
+
+    girara_list_free(subtrees);
+    subtrees = next;
+    if (split == false) {
+      break;
+    }
+  }
+
+  const size_t n_subtrees = girara_list_size(subtrees);
+  const size_t n_tasks    = MIN(n_subtrees, target);
+  node_free_task_t* tasks = g_try_malloc0_n(n_tasks, sizeof(node_free_task_t));
+  if (tasks == NULL) {
+    for (size_t idx = 0; idx != n_subtrees; ++idx) {
+      node_free_subtree(girara_list_nth(subtrees, idx), NULL);
+    }
+  } else {
+    GThreadPool* pool = g_thread_pool_new(node_free_task, NULL, n_threads, FALSE, NULL);
+    for (size_t idx = 0; idx != n_tasks; ++idx) {
+      tasks[idx].subtrees = subtrees;
+      tasks[idx].begin    = idx * n_subtrees / n_tasks;
+      tasks[idx].end      = (idx + 1) * n_subtrees / n_tasks;
+      if (pool == NULL || g_thread_pool_push(pool, &tasks[idx], NULL) == FALSE) {
+        node_free_task(&tasks[idx], NULL);
+      }
+    }
+    if (pool != NULL) {
+      g_thread_pool_free(pool, FALSE, TRUE);
+    }
+
+    /* pools are not thread-safe, so pooled nodes are released here */
+    for (size_t idx = 0; idx != n_tasks; ++idx) {
+      girara_tree_node_t* deferred = tasks[idx].deferred;
+      while (deferred != NULL) {
+        girara_tree_node_t* next = deferred->next;
+        node_release(deferred);
+        deferred = next;
+      }
+    }
+    g_free(tasks);
+  }
+
+  for (size_t idx = girara_list_size(top); idx-- > 0;) {
+    node_release(girara_list_nth(top, idx));
+  }
+}
+
+static bool node_is_ancestor(const girara_tree_node_t* ancestor, const girara_tree_node_t* node) {
+  if (ancestor->root != node->root || node->depth < ancestor->depth) {
+    return false;
+  }
+
+  while (node->depth > ancestor->depth) {
+    node = node->parent;
+  }
+  return node == ancestor;
+}
+
+/* Link a detached child between two siblings of which either may be NULL. */
+static void node_link(girara_tree_node_t* parent, girara_tree_node_t* child, girara_tree_node_t* prev,
+                      girara_tree_node_t* next) {
+  child->parent = parent;
+  child->prev   = prev;
+  child->next   = next;
+  if (prev != NULL) {
+    prev->next = child;
+  } else {
+    parent->children = child;
+  }
+  if (next != NULL) {
+    next->prev = child;
+  } else {
+    parent->last_child = child;
+  }
+  ++parent->n_children;
+
+  node_update_subtree(child, parent->root, parent->depth + 1);
+  node_index_insert(parent, child);
+  /* only the root keeps the key functions */
+  g_clear_pointer(&child->keys, g_free);
 }
 
 void girara_node_append(girara_tree_node_t* parent, girara_tree_node_t* child) {
   g_return_if_fail(parent && child);
-  g_node_append(parent->node, child->node);
+  g_return_if_fail(child->parent == NULL && child != parent->root);
+
+  node_link(parent, child, parent->last_child, NULL);
+}
+
+void girara_node_prepend(girara_tree_node_t* parent, girara_tree_node_t* child) {
+  g_return_if_fail(parent && child);
+  g_return_if_fail(child->parent == NULL && child != parent->root);
+
+  node_link(parent, child, NULL, parent->children);
+}
+
+void girara_node_insert_before(girara_tree_node_t* sibling, girara_tree_node_t* node) {
+  g_return_if_fail(sibling && node);
+  g_return_if_fail(sibling->parent != NULL);
+  g_return_if_fail(node->parent == NULL && node != sibling->root);
+
+  node_link(sibling->parent, node, sibling->prev, sibling);
+}
+
+void girara_node_insert_after(girara_tree_node_t* sibling, girara_tree_node_t* node) {
+  g_return_if_fail(sibling && node);
+  g_return_if_fail(sibling->parent != NULL);
+  g_return_if_fail(node->parent == NULL && node != sibling->root);
+
+  node_link(sibling->parent, node, sibling, sibling->next);
+}
+
+/* Keep the key functions of the tree in a node that is about to become a root,
+ * so that the indexes of its subtree stay valid. */
+static void node_inherit_keys(girara_tree_node_t* node) {
+  const node_keys_t* keys = node->root->keys;
+  if (keys == NULL) {
+    g_clear_pointer(&node->keys, g_free);
+  } else {
+    if (node->keys == NULL) {
+      node->keys = g_try_malloc0(sizeof(node_keys_t));
+    }
+    if (node->keys != NULL) {
+      *node->keys = *keys;
+    }
+  }
+}
+
+void girara_node_unlink(girara_tree_node_t* node) {
+  g_return_if_fail(node);
+
+  if (node->parent == NULL) {
+    return;
+  }
+
+  node_inherit_keys(node);
+  node_unlink(node);
+  node_update_subtree(node, node, 0);
+}
+
+void node_replace(girara_tree_node_t* node, girara_tree_node_t* replacement) {
+  girara_tree_node_t* parent = node->parent;
+
+  replacement->parent = parent;
+  replacement->prev   = node->prev;
+  replacement->next   = node->next;
+  if (node->prev != NULL) {
+    node->prev->next = replacement;
+  } else {
+    parent->children = replacement;
+  }
+  if (node->next != NULL) {
+    node->next->prev = replacement;
+  } else {
+    parent->last_child = replacement;
+  }
+  node_index_replace(parent, node, node->data, replacement, replacement->data);
+
+  node_inherit_keys(node);
+  node->parent = NULL;
+  node->prev   = NULL;
+  node->next   = NULL;
+  node_update_subtree(node, node, 0);
+  node_update_subtree(replacement, parent->root, parent->depth + 1);
+  g_clear_pointer(&replacement->keys, g_free);
+}
+
+void girara_node_move(girara_tree_node_t* node, girara_tree_node_t* new_parent, size_t position) {
+  g_return_if_fail(node && new_parent);
+  g_return_if_fail(node_is_ancestor(node, new_parent) == false);
+
+  node_unlink(node);
+
+  /* walk from the closer end */
+  girara_tree_node_t* next = NULL;
+  if (position < new_parent->n_children / 2) {
+    next = new_parent->children;
+    for (size_t idx = 0; idx != position; ++idx) {
+      next = next->next;
+    }
+  } else if (position < new_parent->n_children) {
+    next = new_parent->last_child;
+    for (size_t idx = new_parent->n_children - 1; idx != position; --idx) {
+      next = next->prev;
+    }
+  }
+
+  node_link(new_parent, node, next != NULL ? next->prev : new_parent->last_child, next);
+}
+
+girara_tree_node_t* girara_node_build(void* const* data, const size_t* parent_index, size_t n) {
+  return girara_node_build_with_free(data, parent_index, n, NULL);
+}
+
+girara_tree_node_t* girara_node_build_with_free(void* const* data, const size_t* parent_index, size_t n,
+                                                girara_free_function_t gfree) {
+  g_return_val_if_fail(data != NULL && parent_index != NULL && n != 0, NULL);
+  g_return_val_if_fail(parent_index[0] == GIRARA_FLAT_TREE_NONE, NULL);
+  for (size_t idx = 1; idx != n; ++idx) {
+    g_return_val_if_fail(parent_index[idx] < idx, NULL);
+  }
+
+  /* all nodes come from a single slab of a pool that goes away with the tree */
+  girara_tree_pool_t* pool = girara_tree_pool_new();
+  if (pool == NULL) {
+    return NULL;
+  }
+  tree_pool_slab_t* slab = tree_pool_add_slab(pool, n);
+  if (slab == NULL) {
+    girara_tree_pool_free(pool);
+    return NULL;
+  }
+  slab->used = n;
+  pool->live = n;
+
+  girara_tree_node_t* nodes = slab->nodes;
+  memset(nodes, 0, n * sizeof(girara_tree_node_t));
+  for (size_t idx = 0; idx != n; ++idx) {
+    girara_tree_node_t* node = &nodes[idx];
+    node->root               = nodes;
+    node->pool               = pool;
+    node->free               = gfree;
+    node->data               = data[idx];
+    if (idx == 0) {
+      continue;
+    }
+
+    /* parents precede their children, so appending keeps the order */
+    girara_tree_node_t* parent = &nodes[parent_index[idx]];
+    node->parent               = parent;
+    node->prev                 = parent->last_child;
+    node->depth                = parent->depth + 1;
+    if (parent->last_child != NULL) {
+      parent->last_child->next = node;
+    } else {
+      parent->children = node;
+    }
+    parent->last_child = node;
+    ++parent->n_children;
+  }
+
+  girara_tree_pool_free(pool);
+  return nodes;
+}
+
+bool node_walk_flat(girara_tree_node_t* root, size_t max_depth, node_flat_visitor_t visitor, void* userdata) {
+  /* index of the last node seen on each level */
+  size_t* ancestors = g_try_malloc_n(max_depth + 1, sizeof(size_t));
+  if (ancestors == NULL) {
+    return false;
+  }
+
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, root, GIRARA_NODE_PRE_ORDER);
+  girara_tree_node_t* node = NULL;
+  for (size_t idx = 0; (node = girara_node_iter_next(&iter)) != NULL; ++idx) {
+    const size_t depth  = node->depth - root->depth;
+    const size_t parent = depth == 0 ? GIRARA_FLAT_TREE_NONE : ancestors[depth - 1];
+    ancestors[depth]    = idx;
+    visitor(node, idx, parent, userdata);
+  }
+  g_free(ancestors);
+
+  return true;
+}
+
+typedef struct node_flat_arrays_s {
+  void** data;
+  size_t* parent;
+} node_flat_arrays_t;
+
+static void node_flatten_visit(girara_tree_node_t* node, size_t index, size_t parent, void* userdata) {
+  node_flat_arrays_t* arrays = userdata;
+  arrays->data[index]        = node->data;
+  arrays->parent[index]      = parent;
+}
+
+size_t girara_node_flatten(girara_tree_node_t* root, void*** data, size_t** parent_index) {
+  g_return_val_if_fail(root != NULL && data != NULL && parent_index != NULL, 0);
+
+  size_t size      = 0;
+  size_t max_depth = 0;
+  {
+    g_auto(girara_node_iter_t) iter;
+    girara_node_iter_init(&iter, root, GIRARA_NODE_PRE_ORDER);
+    girara_tree_node_t* node = NULL;
+    while ((node = girara_node_iter_next(&iter)) != NULL) {
+      max_depth = MAX(max_depth, node->depth - root->depth);
+      ++size;
+    }
+  }
+
+  node_flat_arrays_t arrays = {
+      .data   = g_try_malloc_n(size, sizeof(void*)),
+      .parent = g_try_malloc_n(size, sizeof(size_t)),
+  };
+  if (arrays.data == NULL || arrays.parent == NULL ||
+      node_walk_flat(root, max_depth, node_flatten_visit, &arrays) == false) {
+    g_free(arrays.data);
+    g_free(arrays.parent);
+    return 0;
+  }
+
+  *data         = arrays.data;
+  *parent_index = arrays.parent;
+  return size;
 }
 
 girara_tree_node_t* girara_node_append_data(girara_tree_node_t* parent, void* data) {
   g_return_val_if_fail(parent, NULL);
-  girara_tree_node_t* child = girara_node_new(data);
+  girara_tree_node_t* child = girara_node_new_in_pool(parent->pool, data);
   g_return_val_if_fail(child, NULL);
   child->free = parent->free;
   girara_node_append(parent, child);
@@ -70,31 +731,21 @@ girara_tree_node_t* girara_node_append_data(girara_tree_node_t* parent, void* da
 }
 
 girara_tree_node_t* girara_node_get_parent(girara_tree_node_t* node) {
-  g_return_val_if_fail(node && node->node, NULL);
-
-  if (node->node->parent == NULL) {
-    return NULL;
-  }
-
-  girara_tree_node_t* parent = node->node->parent->data;
-  g_return_val_if_fail(parent, NULL);
+  g_return_val_if_fail(node, NULL);
 
-  return parent;
+  return node->parent;
 }
 
 girara_tree_node_t* girara_node_get_root(girara_tree_node_t* node) {
-  g_return_val_if_fail(node && node->node, NULL);
+  g_return_val_if_fail(node, NULL);
 
-  if (node->node->parent == NULL) {
-    return node;
-  }
+  return node->root;
+}
 
-  GNode* root = g_node_get_root(node->node);
-  g_return_val_if_fail(root, NULL);
-  girara_tree_node_t* root_node = root->data;
-  g_return_val_if_fail(root_node, NULL);
+size_t girara_node_get_depth(girara_tree_node_t* node) {
+  g_return_val_if_fail(node, 0);
 
-  return root_node;
+  return node->depth;
 }
 
 girara_list_t* girara_node_get_children(girara_tree_node_t* node) {
@@ -102,19 +753,223 @@ girara_list_t* girara_node_get_children(girara_tree_node_t* node) {
   girara_list_t* list = girara_list_new();
   g_return_val_if_fail(list, NULL);
 
-  GNode* childnode = node->node->children;
-  while (childnode != NULL) {
-    girara_list_append(list, childnode->data);
-    childnode = childnode->next;
+  for (girara_tree_node_t* child = node->children; child != NULL; child = child->next) {
+    girara_list_append(list, child);
   }
 
   return list;
 }
 
+void girara_node_foreach_child(girara_tree_node_t* node, girara_node_callback_t callback, void* userdata) {
+  g_return_if_fail(node && callback);
+
+  girara_tree_node_t* child = node->children;
+  while (child != NULL) {
+    girara_tree_node_t* next = child->next;
+    callback(child, userdata);
+    child = next;
+  }
+}
+
+girara_tree_node_t* girara_node_get_first_child(girara_tree_node_t* node) {
+  g_return_val_if_fail(node, NULL);
+
+  return node->children;
+}
+
+girara_tree_node_t* girara_node_get_last_child(girara_tree_node_t* node) {
+  g_return_val_if_fail(node, NULL);
+
+  return node->last_child;
+}
+
+girara_tree_node_t* girara_node_get_next_sibling(girara_tree_node_t* node) {
+  g_return_val_if_fail(node, NULL);
+
+  return node->next;
+}
+
+girara_tree_node_t* girara_node_get_previous_sibling(girara_tree_node_t* node) {
+  g_return_val_if_fail(node, NULL);
+
+  return node->prev;
+}
+
 size_t girara_node_get_num_children(girara_tree_node_t* node) {
-  g_return_val_if_fail(node && node->node, 0);
+  g_return_val_if_fail(node, 0);
+
+  return node->n_children;
+}
+
+void girara_node_iter_init(girara_node_iter_t* iter, girara_tree_node_t* root, girara_node_traverse_order_t order) {
+  g_return_if_fail(iter != NULL);
+
+  memset(iter, 0, sizeof(girara_node_iter_t));
+  iter->root  = root;
+  iter->order = order;
+  iter->done  = root == NULL;
+}
+
+static bool node_iter_push(girara_node_iter_t* iter, girara_tree_node_t* node) {
+  if (iter->queue_size == iter->queue_capacity) {
+    const size_t capacity       = iter->queue_capacity != 0 ? iter->queue_capacity * 2 : 16;
+    girara_tree_node_t** queue = g_try_malloc_n(capacity, sizeof(girara_tree_node_t*));
+    if (queue == NULL) {
+      return false;
+    }
 
-  return g_node_n_children(node->node);
+    for (size_t idx = 0; idx != iter->queue_size; ++idx) {
+      queue[idx] = iter->queue[(iter->queue_head + idx) % iter->queue_capacity];
+    }
+    g_free(iter->queue);
+    iter->queue          = queue;
+    iter->queue_head     = 0;
+    iter->queue_capacity = capacity;
+  }
+
+  iter->queue[(iter->queue_head + iter->queue_size) % iter->queue_capacity] = node;
+  ++iter->queue_size;
+  return true;
+}
+
+static girara_tree_node_t* node_iter_next_pre_order(girara_node_iter_t* iter) {
+  girara_tree_node_t* node = iter->current;
+  if (node == NULL) {
+    return iter->root;
+  }
+
+  if (iter->skip_children == false && node->children != NULL) {
+    return node->children;
+  }
+
+  while (node != iter->root && node->next == NULL) {
+    node = node->parent;
+  }
+
+  return node != iter->root ? node->next : NULL;
+}
+
+static girara_tree_node_t* node_iter_leftmost_leaf(girara_tree_node_t* node) {
+  while (node->children != NULL) {
+    node = node->children;
+  }
+
+  return node;
+}
+
+static girara_tree_node_t* node_iter_next_post_order(girara_node_iter_t* iter) {
+  girara_tree_node_t* node = iter->current;
+  if (node == NULL) {
+    return node_iter_leftmost_leaf(iter->root);
+  }
+
+  if (node == iter->root) {
+    return NULL;
+  }
+
+  if (node->next != NULL) {
+    return node_iter_leftmost_leaf(node->next);
+  }
+
+  return node->parent;
+}
+
+static girara_tree_node_t* node_iter_next_level_order(girara_node_iter_t* iter) {
+  girara_tree_node_t* node = iter->current;
+  if (node == NULL) {
+    return iter->root;
+  }
+
+  if (iter->skip_children == false && node->children != NULL) {
+    if (node_iter_push(iter, node) == false) {
+      iter->failed = true;
+      return NULL;
+    }
+  }
+
+  if (iter->sibling == NULL) {
+    if (iter->queue_size == 0) {
+      return NULL;
+    }
+
+    girara_tree_node_t* parent = iter->queue[iter->queue_head];
+    iter->queue_head           = (iter->queue_head + 1) % iter->queue_capacity;
+    --iter->queue_size;
+    iter->sibling = parent->children;
+  }
+
+  node          = iter->sibling;
+  iter->sibling = node->next;
+  return node;
+}
+
+girara_tree_node_t* girara_node_iter_next(girara_node_iter_t* iter) {
+  g_return_val_if_fail(iter != NULL, NULL);
+  if (iter->done == true) {
+    return NULL;
+  }
+
+  girara_tree_node_t* node = NULL;
+  switch (iter->order) {
+  case GIRARA_NODE_PRE_ORDER:
+    node = node_iter_next_pre_order(iter);
+    break;
+  case GIRARA_NODE_POST_ORDER:
+    node = node_iter_next_post_order(iter);
+    break;
+  case GIRARA_NODE_LEVEL_ORDER:
+    node = node_iter_next_level_order(iter);
+    break;
+  }
+
+  iter->current       = node;
+  iter->skip_children = false;
+  iter->done          = node == NULL;
+  return node;
+}
+
+bool girara_node_iter_failed(const girara_node_iter_t* iter) {
+  g_return_val_if_fail(iter != NULL, false);
+  return iter->failed;
+}
+
+void girara_node_iter_skip_children(girara_node_iter_t* iter) {
+  g_return_if_fail(iter != NULL);
+  iter->skip_children = true;
+}
+
+void girara_node_iter_clear(girara_node_iter_t* iter) {
+  g_return_if_fail(iter != NULL);
+
+  g_free(iter->queue);
+  iter->queue          = NULL;
+  iter->queue_head     = 0;
+  iter->queue_size     = 0;
+  iter->queue_capacity = 0;
+  iter->done           = true;
+}
+
+bool girara_node_traverse(girara_tree_node_t* root, girara_node_traverse_order_t order,
+                          girara_node_traverse_function_t callback, void* userdata) {
+  g_return_val_if_fail(root != NULL && callback != NULL, false);
+
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, root, order);
+
+  girara_tree_node_t* node = NULL;
+  while ((node = girara_node_iter_next(&iter)) != NULL) {
+    switch (callback(node, userdata)) {
+    case GIRARA_NODE_TRAVERSE_CONTINUE:
+      break;
+    case GIRARA_NODE_TRAVERSE_SKIP_CHILDREN:
+      girara_node_iter_skip_children(&iter);
+      break;
+    case GIRARA_NODE_TRAVERSE_STOP:
+      return false;
+    }
+  }
+
+  return girara_node_iter_failed(&iter) == false;
 }
 
 void* girara_node_get_data(girara_tree_node_t* node) {
@@ -126,9 +981,75 @@ void* girara_node_get_data(girara_tree_node_t* node) {
 void girara_node_set_data(girara_tree_node_t* node, void* data) {
   g_return_if_fail(node);
 
+  if (node->parent != NULL) {
+    node_index_replace(node->parent, node, node->data, node, data);
+  }
+
   if (node->free != NULL) {
     node->free(node->data);
   }
 
   node->data = data;
 }
+
+void girara_node_set_key_function(girara_tree_node_t* root, GHashFunc hash, GEqualFunc equal) {
+  g_return_if_fail(root != NULL && root->parent == NULL);
+  g_return_if_fail((hash == NULL) == (equal == NULL));
+
+  g_clear_pointer(&root->keys, g_free);
+  if (hash != NULL) {
+    root->keys = g_try_malloc0(sizeof(node_keys_t));
+    g_return_if_fail(root->keys != NULL);
+    root->keys->hash  = hash;
+    root->keys->equal = equal;
+  }
+
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, root, GIRARA_NODE_PRE_ORDER);
+  girara_tree_node_t* node = NULL;
+  while ((node = girara_node_iter_next(&iter)) != NULL) {
+    node_index_clear(node);
+  }
+}
+
+girara_tree_node_t* girara_node_find_child(girara_tree_node_t* node, const void* key) {
+  g_return_val_if_fail(node != NULL, NULL);
+
+  const node_keys_t* keys = node->root->keys;
+  GEqualFunc equal        = keys != NULL ? keys->equal : g_direct_equal;
+
+  if (node->n_children < NODE_INDEX_THRESHOLD) {
+    node_index_clear(node);
+    for (girara_tree_node_t* child = node->children; child != NULL; child = child->next) {
+      if (equal(child->data, key)) {
+        return child;
+      }
+    }
+    return NULL;
+  }
+
+  if (node->index == NULL || node->index_dirty == true) {
+    node_index_clear(node);
+    node->index = g_hash_table_new(keys != NULL ? keys->hash : g_direct_hash, equal);
+    for (girara_tree_node_t* child = node->children; child != NULL; child = child->next) {
+      if (g_hash_table_contains(node->index, child->data) == FALSE) {
+        g_hash_table_insert(node->index, child->data, child);
+      }
+    }
+    node->index_dirty = false;
+  }
+
+  return g_hash_table_lookup(node->index, key);
+}
+
+girara_tree_node_t* girara_node_find_path(girara_tree_node_t* root, const void* const* keys, size_t n) {
+  g_return_val_if_fail(root != NULL, NULL);
+  g_return_val_if_fail(n == 0 || keys != NULL, NULL);
+
+  girara_tree_node_t* node = root;
+  for (size_t idx = 0; idx != n && node != NULL; ++idx) {
+    node = girara_node_find_child(node, keys[idx]);
+  }
+
+  return node;
+}
@@ -0,0 +1,229 @@
+/* SPDX-License-Identifier: Zlib */
+
+#include "datastructures.h"
+
+#include <string.h>
+#include <gio/gio.h>
+
+#include "internal.h"
+
+/* File layout: header, node table in pre-order, data blob. All integers are
+ * stored in little endian. The checksum covers the node table and the data. */
+
+#define TREE_FILE_MAGIC "GIRTREE"
+#define TREE_FILE_VERSION 1
+#define TREE_FILE_ALIGNMENT 8
+#define TREE_FILE_NO_PARENT G_MAXUINT64
+
+typedef struct tree_file_header_s {
+  char magic[8];       /**> TREE_FILE_MAGIC including the terminating NUL */
+  guint32 version;     /**> Format version */
+  guint32 flags;       /**> Reserved, always 0 */
+  guint64 n_nodes;     /**> Number of entries in the node table */
+  guint64 data_size;   /**> Size of the data blob */
+  guint8 checksum[32]; /**> SHA-256 of node table and data blob */
+} tree_file_header_t;
+
+typedef struct tree_file_node_s {
+  guint64 parent; /**> Index of the parent or TREE_FILE_NO_PARENT */
+  guint64 offset; /**> Offset of the data in the data blob */
+  guint64 length; /**> Length of the data */
+} tree_file_node_t;
+
+G_STATIC_ASSERT(sizeof(tree_file_header_t) == 64);
+G_STATIC_ASSERT(sizeof(tree_file_node_t) == 24);
+
+G_DEFINE_QUARK(girara-tree-error-quark, girara_tree_error)
+
+static void tree_file_checksum(const void* nodes, size_t nodes_size, const void* data, size_t data_size,
+                               guint8 digest[32]) {
+  GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+  g_checksum_update(checksum, nodes, nodes_size);
+  g_checksum_update(checksum, data, data_size);
+
+  gsize digest_len = 32;
+  g_checksum_get_digest(checksum, digest, &digest_len);
+  g_checksum_free(checksum);
+}
+
+bool girara_node_serialize(girara_tree_node_t* root, GOutputStream* stream, girara_node_data_writer_t writer,
+                           void* userdata, GError** error) {
+  g_return_val_if_fail(root != NULL, false);
+  g_return_val_if_fail(G_IS_OUTPUT_STREAM(stream), false);
+  g_return_val_if_fail(writer != NULL, false);
+  g_return_val_if_fail(error == NULL || *error == NULL, false);
+
+  g_autoptr(GArray) nodes     = g_array_new(FALSE, FALSE, sizeof(tree_file_node_t));
+  g_autoptr(GArray) ancestors = g_array_new(FALSE, FALSE, sizeof(guint64));
+  g_autoptr(GByteArray) data  = g_byte_array_new();
+  const size_t root_depth     = girara_node_get_depth(root);
+
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, root, GIRARA_NODE_PRE_ORDER);
+  girara_tree_node_t* node = NULL;
+  for (guint64 idx = 0; (node = girara_node_iter_next(&iter)) != NULL; ++idx) {
+    const size_t depth = girara_node_get_depth(node) - root_depth;
+    g_array_set_size(ancestors, depth + 1);
+    g_array_index(ancestors, guint64, depth) = idx;
+
+    /* keep the data aligned so that it can be referenced in place */
+    static const guint8 padding[TREE_FILE_ALIGNMENT] = {0};
+    g_byte_array_append(data, padding, (TREE_FILE_ALIGNMENT - data->len % TREE_FILE_ALIGNMENT) % TREE_FILE_ALIGNMENT);
+
+    const guint64 offset = data->len;
+    if (writer(girara_node_get_data(node), data, userdata) == false) {
+      g_set_error(error, GIRARA_TREE_ERROR, GIRARA_TREE_ERROR_DATA,
+                  "Failed to serialize the data of node %" G_GUINT64_FORMAT, idx);
+      return false;
+    }
+
+    const guint64 parent   = depth == 0 ? TREE_FILE_NO_PARENT : g_array_index(ancestors, guint64, depth - 1);
+    tree_file_node_t entry = {
+        .parent = GUINT64_TO_LE(parent),
+        .offset = GUINT64_TO_LE(offset),
+        .length = GUINT64_TO_LE(data->len - offset),
+    };
+    g_array_append_val(nodes, entry);
+  }
+
+  tree_file_header_t header = {
+      .magic     = TREE_FILE_MAGIC,
+      .version   = GUINT32_TO_LE(TREE_FILE_VERSION),
+      .flags     = 0,
+      .n_nodes   = GUINT64_TO_LE(nodes->len),
+      .data_size = GUINT64_TO_LE(data->len),
+  };
+  const size_t nodes_size = nodes->len * sizeof(tree_file_node_t);
+  tree_file_checksum(nodes->data, nodes_size, data->data, data->len, header.checksum);
+
+  return g_output_stream_write_all(stream, &header, sizeof(header), NULL, NULL, error) &&
+         g_output_stream_write_all(stream, nodes->data, nodes_size, NULL, NULL, error) &&
+         g_output_stream_write_all(stream, data->data, data->len, NULL, NULL, error);
+}
+
+static guint64 tree_file_parent(const guint8* nodes, guint64 idx) {
+  tree_file_node_t entry;
+  memcpy(&entry, nodes + idx * sizeof(entry), sizeof(entry));
+  return GUINT64_FROM_LE(entry.parent);
+}
+
+static bool tree_file_validate(const guint8* contents, size_t size, GError** error) {
+  tree_file_header_t header;
+  if (size < sizeof(header)) {
+    g_set_error_literal(error, GIRARA_TREE_ERROR, GIRARA_TREE_ERROR_INVALID_FORMAT, "File is too short");
+    return false;
+  }
+
+  memcpy(&header, contents, sizeof(header));
+  if (memcmp(header.magic, TREE_FILE_MAGIC, sizeof(header.magic)) != 0) {
+    g_set_error_literal(error, GIRARA_TREE_ERROR, GIRARA_TREE_ERROR_INVALID_FORMAT, "Not a serialized tree");
+    return false;
+  }
+  if (GUINT32_FROM_LE(header.version) != TREE_FILE_VERSION) {
+    g_set_error(error, GIRARA_TREE_ERROR, GIRARA_TREE_ERROR_VERSION, "Unsupported format version %u",
+                GUINT32_FROM_LE(header.version));
+    return false;
+  }
+
+  const guint64 n_nodes   = GUINT64_FROM_LE(header.n_nodes);
+  const guint64 data_size = GUINT64_FROM_LE(header.data_size);
+  const size_t available  = size - sizeof(header);
+  if (n_nodes == 0 || n_nodes > available / sizeof(tree_file_node_t) ||
+      data_size != available - n_nodes * sizeof(tree_file_node_t)) {
+    g_set_error_literal(error, GIRARA_TREE_ERROR, GIRARA_TREE_ERROR_INVALID_FORMAT, "File size does not match");
+    return false;
+  }
+
+  const guint8* nodes     = contents + sizeof(header);
+  const size_t nodes_size = n_nodes * sizeof(tree_file_node_t);
+  guint8 digest[32];
+  tree_file_checksum(nodes, nodes_size, nodes + nodes_size, data_size, digest);
+  if (memcmp(digest, header.checksum, sizeof(digest)) != 0) {
+    g_set_error_literal(error, GIRARA_TREE_ERROR, GIRARA_TREE_ERROR_CHECKSUM, "Checksum mismatch");
+    return false;
+  }
+
+  /* In pre-order, the parent of a node is the previous node or one of its
+   * ancestors. The nodes passed on the way up are complete and never passed
+   * again, so checking this is linear in the number of nodes. The data needs
+   * to be in the blob. */
+  for (guint64 idx = 0; idx != n_nodes; ++idx) {
+    tree_file_node_t entry;
+    memcpy(&entry, nodes + idx * sizeof(entry), sizeof(entry));
+    const guint64 parent = GUINT64_FROM_LE(entry.parent);
+    const guint64 offset = GUINT64_FROM_LE(entry.offset);
+    const guint64 length = GUINT64_FROM_LE(entry.length);
+
+    guint64 ancestor = idx - 1;
+    if (idx != 0 && parent < idx) {
+      while (ancestor != parent && ancestor != 0) {
+        ancestor = tree_file_parent(nodes, ancestor);
+      }
+    }
+
+    if ((idx == 0 ? parent != TREE_FILE_NO_PARENT : ancestor != parent) || offset > data_size ||
+        length > data_size - offset) {
+      g_set_error(error, GIRARA_TREE_ERROR, GIRARA_TREE_ERROR_INVALID_FORMAT,
+                  "Invalid entry for node %" G_GUINT64_FORMAT, idx);
+      return false;
+    }
+  }
+
+  return true;
+}
+
+girara_flat_tree_t* girara_flat_tree_load_bytes(GBytes* bytes, girara_node_data_reader_t reader, void* userdata,
+                                                girara_free_function_t gfree, GError** error) {
+  g_return_val_if_fail(bytes != NULL, NULL);
+  g_return_val_if_fail(reader != NULL || gfree == NULL, NULL);
+  g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+  size_t size            = 0;
+  const guint8* contents = g_bytes_get_data(bytes, &size);
+  if (tree_file_validate(contents, size, error) == false) {
+    return NULL;
+  }
+
+  tree_file_header_t header;
+  memcpy(&header, contents, sizeof(header));
+  const guint64 n_nodes = GUINT64_FROM_LE(header.n_nodes);
+  const guint8* nodes   = contents + sizeof(header);
+  const guint8* data    = nodes + n_nodes * sizeof(tree_file_node_t);
+
+  girara_flat_tree_t* tree = flat_tree_new(n_nodes, gfree);
+  if (tree == NULL) {
+    g_set_error_literal(error, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to allocate the tree");
+    return NULL;
+  }
+  flat_tree_set_backing(tree, bytes);
+
+  for (guint64 idx = 0; idx != n_nodes; ++idx) {
+    tree_file_node_t entry;
+    memcpy(&entry, nodes + idx * sizeof(entry), sizeof(entry));
+    const guint64 parent = GUINT64_FROM_LE(entry.parent);
+    const guint8* value  = data + GUINT64_FROM_LE(entry.offset);
+    const size_t length  = GUINT64_FROM_LE(entry.length);
+
+    flat_tree_set_node(tree, idx, reader != NULL ? reader(value, length, userdata) : (void*)value,
+                       parent == TREE_FILE_NO_PARENT ? GIRARA_FLAT_TREE_NONE : parent);
+  }
+
+  flat_tree_finish(tree);
+  return tree;
+}
+
+girara_flat_tree_t* girara_flat_tree_load(const char* path, girara_node_data_reader_t reader, void* userdata,
+                                          girara_free_function_t gfree, GError** error) {
+  g_return_val_if_fail(path != NULL, NULL);
+  g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+  GMappedFile* file = g_mapped_file_new(path, FALSE, error);
+  if (file == NULL) {
+    return NULL;
+  }
+
+  g_autoptr(GBytes) bytes = g_mapped_file_get_bytes(file);
+  g_mapped_file_unref(file);
+
+  return girara_flat_tree_load_bytes(bytes, reader, userdata, gfree, error);
+}
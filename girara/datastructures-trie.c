@@ -0,0 +1,740 @@
+/* SPDX-License-Identifier: Zlib */
+
+#include "datastructures.h"
+
+#include <string.h>
+#include <glib.h>
+
+#include "internal.h"
+
+/* Every node of the underlying girara tree holds the edge leading to it. The
+ * children of a node are keyed by the first byte of their label. */
+typedef struct trie_edge_s {
+  char* label;   /**> Label of the edge, points behind the struct */
+  size_t length; /**> Length of the label */
+  size_t count;  /**> Number of entries in the subtree */
+  bool terminal; /**> An entry ends at this node */
+  void* value;   /**> Value of the entry */
+  size_t rank;   /**> Rank of the entry, see trie_set_rank */
+  size_t top;    /**> Highest rank in the subtree plus one, 0 if there are no entries */
+  guint64 mask;  /**> Characters of the labels in the subtree, see fuzzy_mask */
+} trie_edge_t;
+
+struct girara_trie_s {
+  girara_tree_node_t* root;    /**> Root node with an empty label */
+  size_t n_nodes;              /**> Number of nodes */
+  size_t label_bytes;          /**> Total length of all labels */
+  girara_free_function_t free; /**> Free function for the values */
+};
+
+struct girara_trie_iter_s {
+  girara_node_iter_t nodes; /**> Pre-order iterator below the prefix */
+  size_t start_depth;        /**> Depth of the first node */
+  GString* key;              /**> Key of the current node */
+  GArray* lengths;           /**> Key length after each level */
+};
+
+static guint trie_edge_hash(gconstpointer data) {
+  const trie_edge_t* edge = data;
+  return (guchar)edge->label[0];
+}
+
+static gboolean trie_edge_equal(gconstpointer lhs, gconstpointer rhs) {
+  const trie_edge_t* lhs_edge = lhs;
+  const trie_edge_t* rhs_edge = rhs;
+  return lhs_edge->label[0] == rhs_edge->label[0];
+}
+
+static trie_edge_t* trie_edge_new(const char* label, size_t length) {
+  trie_edge_t* edge = g_try_malloc0(sizeof(trie_edge_t) + length + 1);
+  if (edge == NULL) {
+    return NULL;
+  }
+
+  edge->label  = (char*)(edge + 1);
+  edge->length = length;
+  memcpy(edge->label, label, length);
+  edge->label[length] = '\0';
+  edge->mask          = fuzzy_mask(edge->label);
+
+  return edge;
+}
+
+static trie_edge_t* trie_get_edge(girara_tree_node_t* node) {
+  return girara_node_get_data(node);
+}
+
+static size_t common_prefix_length(const char* lhs, const char* rhs, size_t length) {
+  size_t idx = 0;
+  while (idx != length && lhs[idx] == rhs[idx] && lhs[idx] != '\0') {
+    ++idx;
+  }
+  return idx;
+}
+
+static girara_tree_node_t* trie_find_child(girara_tree_node_t* node, const char* key) {
+  trie_edge_t probe = {.label = (char*)key};
+  return girara_node_find_child(node, &probe);
+}
+
+/* Compute the highest rank and the mask of a node from its entry, its label and
+ * its children. */
+static void trie_compute(girara_tree_node_t* node, size_t* top, guint64* mask) {
+  const trie_edge_t* edge   = trie_get_edge(node);
+  *top                      = edge->terminal == true ? edge->rank + 1 : 0;
+  *mask                     = fuzzy_mask(edge->label);
+  girara_tree_node_t* child = girara_node_get_first_child(node);
+  for (; child != NULL; child = girara_node_get_next_sibling(child)) {
+    *top = MAX(*top, trie_get_edge(child)->top);
+    *mask |= trie_get_edge(child)->mask;
+  }
+}
+
+girara_trie_t* girara_trie_new(void) {
+  return girara_trie_new_with_free(NULL);
+}
+
+girara_trie_t* girara_trie_new_with_free(girara_free_function_t gfree) {
+  girara_trie_t* trie = g_try_malloc0(sizeof(girara_trie_t));
+  if (trie == NULL) {
+    return NULL;
+  }
+
+  trie_edge_t* edge = trie_edge_new("", 0);
+  if (edge == NULL) {
+    g_free(trie);
+    return NULL;
+  }
+
+  trie->root = girara_node_new(edge);
+  if (trie->root == NULL) {
+    g_free(edge);
+    g_free(trie);
+    return NULL;
+  }
+
+  girara_node_set_key_function(trie->root, trie_edge_hash, trie_edge_equal);
+  trie->n_nodes = 1;
+  trie->free    = gfree;
+
+  return trie;
+}
+
+static void trie_free_edge(girara_trie_t* trie, trie_edge_t* edge) {
+  if (edge->terminal == true && trie->free != NULL) {
+    trie->free(edge->value);
+  }
+  g_free(edge);
+}
+
+void girara_trie_free(girara_trie_t* trie) {
+  if (trie == NULL) {
+    return;
+  }
+
+  {
+    g_auto(girara_node_iter_t) iter;
+    girara_node_iter_init(&iter, trie->root, GIRARA_NODE_PRE_ORDER);
+    girara_tree_node_t* node = NULL;
+    while ((node = girara_node_iter_next(&iter)) != NULL) {
+      trie_free_edge(trie, trie_get_edge(node));
+    }
+  }
+
+  girara_node_free(trie->root);
+  g_free(trie);
+}
+
+/* Split the edge of a node after length bytes and return the new upper node. */
+static girara_tree_node_t* trie_split(girara_trie_t* trie, girara_tree_node_t* node, size_t length) {
+  trie_edge_t* edge  = trie_get_edge(node);
+  trie_edge_t* upper = trie_edge_new(edge->label, length);
+  trie_edge_t* lower = trie_edge_new(edge->label + length, edge->length - length);
+  if (upper == NULL || lower == NULL) {
+    g_free(upper);
+    g_free(lower);
+    return NULL;
+  }
+
+  girara_tree_node_t* upper_node = girara_node_new(upper);
+  if (upper_node == NULL) {
+    g_free(upper);
+    g_free(lower);
+    return NULL;
+  }
+
+  upper->count    = edge->count;
+  upper->top      = edge->top;
+  upper->mask     = edge->mask;
+  lower->count    = edge->count;
+  lower->terminal = edge->terminal;
+  lower->value    = edge->value;
+  lower->rank     = edge->rank;
+
+  /* the upper node takes the place of the node, so the key of the parent's
+   * index does not change */
+  node_replace(node, upper_node);
+  girara_node_set_data(node, lower);
+  g_free(edge);
+  girara_node_append(upper_node, node);
+  trie_compute(node, &lower->top, &lower->mask);
+
+  ++trie->n_nodes;
+  return upper_node;
+}
+
+/* Find the node at which a key ends. If the key ends within an edge, the node
+ * below that edge is returned and offset is set to the number of bytes of its
+ * label that are part of the key. */
+static girara_tree_node_t* trie_find(const girara_trie_t* trie, const char* key, size_t* offset) {
+  girara_tree_node_t* node = trie->root;
+  *offset                  = 0;
+  while (*key != '\0') {
+    node = trie_find_child(node, key);
+    if (node == NULL) {
+      return NULL;
+    }
+
+    const trie_edge_t* edge = trie_get_edge(node);
+    const size_t common     = common_prefix_length(edge->label, key, edge->length);
+    if (key[common] == '\0') {
+      *offset = common;
+      return node;
+    }
+    if (common != edge->length) {
+      return NULL;
+    }
+    key += common;
+  }
+
+  *offset = trie_get_edge(node)->length;
+  return node;
+}
+
+static void trie_update_counts(girara_tree_node_t* node, bool increment) {
+  for (; node != NULL; node = girara_node_get_parent(node)) {
+    trie_edge_t* edge = trie_get_edge(node);
+    if (increment == true) {
+      ++edge->count;
+    } else {
+      --edge->count;
+    }
+  }
+}
+
+/* Raise the highest rank and add characters to the masks of a node and its
+ * ancestors. */
+static void trie_raise(girara_tree_node_t* node, size_t top, guint64 mask) {
+  for (; node != NULL; node = girara_node_get_parent(node)) {
+    trie_edge_t* edge = trie_get_edge(node);
+    if (edge->top >= top && (edge->mask & mask) == mask) {
+      return;
+    }
+    edge->top = MAX(edge->top, top);
+    edge->mask |= mask;
+  }
+}
+
+/* Recompute the highest rank and the mask of a node and its ancestors after
+ * an entry below it was lowered or removed. */
+static void trie_lower(girara_tree_node_t* node) {
+  for (; node != NULL; node = girara_node_get_parent(node)) {
+    trie_edge_t* edge = trie_get_edge(node);
+    size_t top        = 0;
+    guint64 mask      = 0;
+    trie_compute(node, &top, &mask);
+    if (edge->top == top && edge->mask == mask) {
+      return;
+    }
+    edge->top  = top;
+    edge->mask = mask;
+  }
+}
+
+bool girara_trie_insert(girara_trie_t* trie, const char* key, void* value) {
+  g_return_val_if_fail(trie != NULL && key != NULL, false);
+  return trie_insert_ranked(trie, key, value, 0);
+}
+
+bool trie_insert_ranked(girara_trie_t* trie, const char* key, void* value, size_t rank) {
+  girara_tree_node_t* node = trie->root;
+  while (*key != '\0') {
+    girara_tree_node_t* child = trie_find_child(node, key);
+    if (child == NULL) {
+      const size_t length = strlen(key);
+      trie_edge_t* edge   = trie_edge_new(key, length);
+      g_return_val_if_fail(edge != NULL, false);
+      child = girara_node_new(edge);
+      if (child == NULL) {
+        g_free(edge);
+        return false;
+      }
+      girara_node_append(node, child);
+      ++trie->n_nodes;
+      trie->label_bytes += length;
+      node = child;
+      break;
+    }
+
+    const trie_edge_t* edge = trie_get_edge(child);
+    const size_t common     = common_prefix_length(edge->label, key, edge->length);
+    if (common != edge->length) {
+      child = trie_split(trie, child, common);
+      g_return_val_if_fail(child != NULL, false);
+    }
+    key += common;
+    node = child;
+  }
+
+  trie_edge_t* edge = trie_get_edge(node);
+  if (edge->terminal == true) {
+    if (trie->free != NULL && edge->value != value) {
+      trie->free(edge->value);
+    }
+    edge->value = value;
+    return false;
+  }
+
+  edge->terminal = true;
+  edge->value    = value;
+  edge->rank     = rank;
+  trie_update_counts(node, true);
+  trie_raise(node, rank + 1, edge->mask);
+  return true;
+}
+
+/* Merge a node that is no entry with its only child. */
+static void trie_merge(girara_trie_t* trie, girara_tree_node_t* node) {
+  trie_edge_t* edge = trie_get_edge(node);
+  if (node == trie->root || edge->terminal == true || girara_node_get_num_children(node) != 1) {
+    return;
+  }
+
+  girara_tree_node_t* child = girara_node_get_first_child(node);
+  trie_edge_t* child_edge   = trie_get_edge(child);
+  trie_edge_t* merged       = g_try_malloc(sizeof(trie_edge_t) + edge->length + child_edge->length + 1);
+  if (merged == NULL) {
+    return;
+  }
+
+  *merged       = *child_edge;
+  merged->label = (char*)(merged + 1);
+  merged->mask  = edge->mask;
+  merged->length += edge->length;
+  memcpy(merged->label, edge->label, edge->length);
+  memcpy(merged->label + edge->length, child_edge->label, child_edge->length + 1);
+
+  girara_node_unlink(child);
+  girara_node_set_data(child, merged);
+  g_free(child_edge);
+  node_replace(node, child);
+
+  g_free(edge);
+  girara_node_free(node);
+  --trie->n_nodes;
+}
+
+bool girara_trie_remove(girara_trie_t* trie, const char* key) {
+  g_return_val_if_fail(trie != NULL && key != NULL, false);
+
+  size_t offset            = 0;
+  girara_tree_node_t* node = trie_find(trie, key, &offset);
+  if (node == NULL) {
+    return false;
+  }
+
+  trie_edge_t* edge = trie_get_edge(node);
+  if (offset != edge->length || edge->terminal == false) {
+    return false;
+  }
+
+  if (trie->free != NULL) {
+    trie->free(edge->value);
+  }
+  edge->terminal = false;
+  edge->value    = NULL;
+  trie_update_counts(node, false);
+
+  if (node != trie->root && girara_node_get_num_children(node) == 0) {
+    girara_tree_node_t* parent = girara_node_get_parent(node);
+    trie->label_bytes -= edge->length;
+    --trie->n_nodes;
+    /* unlinking the node looks up its edge in the parent's index */
+    girara_node_free(node);
+    g_free(edge);
+    trie_lower(parent);
+    trie_merge(trie, parent);
+  } else {
+    trie_lower(node);
+    trie_merge(trie, node);
+  }
+
+  return true;
+}
+
+bool girara_trie_contains(const girara_trie_t* trie, const char* key) {
+  g_return_val_if_fail(trie != NULL && key != NULL, false);
+
+  size_t offset            = 0;
+  girara_tree_node_t* node = trie_find(trie, key, &offset);
+  const trie_edge_t* edge  = node != NULL ? trie_get_edge(node) : NULL;
+  return edge != NULL && offset == edge->length && edge->terminal == true;
+}
+
+void* girara_trie_lookup(const girara_trie_t* trie, const char* key) {
+  g_return_val_if_fail(trie != NULL && key != NULL, NULL);
+
+  size_t offset            = 0;
+  girara_tree_node_t* node = trie_find(trie, key, &offset);
+  if (node == NULL) {
+    return NULL;
+  }
+
+  const trie_edge_t* edge = trie_get_edge(node);
+  return offset == edge->length && edge->terminal == true ? edge->value : NULL;
+}
+
+size_t girara_trie_size(const girara_trie_t* trie) {
+  g_return_val_if_fail(trie != NULL, 0);
+  return trie_get_edge(trie->root)->count;
+}
+
+size_t girara_trie_count_prefix(const girara_trie_t* trie, const char* prefix) {
+  g_return_val_if_fail(trie != NULL && prefix != NULL, 0);
+
+  size_t offset            = 0;
+  girara_tree_node_t* node = trie_find(trie, prefix, &offset);
+  return node != NULL ? trie_get_edge(node)->count : 0;
+}
+
+void trie_set_rank(girara_trie_t* trie, const char* key, size_t rank) {
+  size_t offset            = 0;
+  girara_tree_node_t* node = trie_find(trie, key, &offset);
+  trie_edge_t* edge        = node != NULL ? trie_get_edge(node) : NULL;
+  if (edge == NULL || offset != edge->length || edge->terminal == false) {
+    return;
+  }
+
+  const size_t old_rank = edge->rank;
+  edge->rank            = rank;
+  if (rank > old_rank) {
+    trie_raise(node, rank + 1, 0);
+  } else {
+    trie_lower(node);
+  }
+}
+
+void trie_set_ranks(girara_trie_t* trie, trie_rank_function_t rank, void* userdata) {
+  /* children are visited before their parent, so their highest ranks are
+   * known when the parent's is computed */
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, trie->root, GIRARA_NODE_POST_ORDER);
+  girara_tree_node_t* node = NULL;
+  while ((node = girara_node_iter_next(&iter)) != NULL) {
+    trie_edge_t* edge = trie_get_edge(node);
+    if (edge->terminal == true) {
+      edge->rank = rank(edge->value, userdata);
+    }
+    trie_compute(node, &edge->top, &edge->mask);
+  }
+}
+
+/* Find the closest rank below or above rank in the subtree of a node. */
+static size_t trie_node_find_rank(girara_tree_node_t* node, size_t rank, bool lower) {
+  /* Only subtrees containing ranks above the highest one below rank need to
+   * be visited for the next lower rank, and only subtrees containing ranks
+   * above rank for the next higher one. */
+  size_t found = lower == true ? 0 : G_MAXSIZE;
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, node, GIRARA_NODE_PRE_ORDER);
+  while ((node = girara_node_iter_next(&iter)) != NULL) {
+    const trie_edge_t* edge = trie_get_edge(node);
+    if (lower == true) {
+      /* found holds the best rank plus one */
+      if (edge->top <= found) {
+        girara_node_iter_skip_children(&iter);
+      } else if (edge->top <= rank) {
+        found = edge->top;
+        girara_node_iter_skip_children(&iter);
+      } else if (edge->terminal == true && edge->rank < rank && edge->rank >= found) {
+        found = edge->rank + 1;
+      }
+    } else {
+      if (edge->top <= rank + 1) {
+        girara_node_iter_skip_children(&iter);
+      } else if (edge->terminal == true && edge->rank > rank && edge->rank < found) {
+        found = edge->rank;
+      }
+    }
+  }
+
+  if (lower == true) {
+    return found != 0 ? found - 1 : G_MAXSIZE;
+  }
+  return found;
+}
+
+size_t trie_find_rank(const girara_trie_t* trie, const char* prefix, size_t rank, bool lower) {
+  size_t offset            = 0;
+  girara_tree_node_t* node = trie_find(trie, prefix, &offset);
+  return node != NULL ? trie_node_find_rank(node, rank, lower) : G_MAXSIZE;
+}
+
+/**
+ * Key length and number of matched pattern characters after a node
+ */
+typedef struct trie_fuzzy_level_s {
+  size_t length;  /**> Length of the key */
+  size_t matched; /**> Number of characters of the pattern matched by the key */
+} trie_fuzzy_level_t;
+
+/**
+ * State of a fuzzy search, see trie_fuzzy_search
+ */
+typedef struct trie_fuzzy_search_s {
+  const fuzzy_pattern_t* pattern;
+  guint64* remaining;          /**> Characters of the pattern after each number of matched ones */
+  GString* key;                /**> Key of the current node */
+  GArray* levels;              /**> Key length and matched characters after each level */
+  GArray* found;               /**> Nodes whose entries match, may be NULL */
+  bool by_rank;                /**> Report the entries below a node highest rank first */
+  size_t budget;               /**> Number of nodes and entries left to visit */
+  trie_match_function_t match; /**> Called for every matching entry */
+  void* userdata;              /**> Passed to match */
+} trie_fuzzy_search_t;
+
+/* Match more characters of the pattern the way fuzzy_match looks for its first
+ * occurrence and return the number of matched characters. */
+static size_t trie_fuzzy_advance(const fuzzy_pattern_t* pattern, size_t matched, const char* text, size_t length) {
+  for (size_t idx = 0; idx != length && matched != pattern->length; ++idx) {
+    if (pattern->fold[(unsigned char)text[idx]] == (unsigned char)pattern->text[matched]) {
+      ++matched;
+    }
+  }
+
+  return matched;
+}
+
+/* Count a visit against the budget of a search and return whether it is
+ * exhausted. */
+static bool trie_fuzzy_spend(trie_fuzzy_search_t* search) {
+  if (search->budget == 0) {
+    return true;
+  }
+
+  --search->budget;
+  return false;
+}
+
+/* Report the entries below a node at which the pattern was matched. Returns
+ * false if the budget ran out. */
+static bool trie_fuzzy_report(trie_fuzzy_search_t* search, girara_tree_node_t* node) {
+  /* the score only depends on the key up to the end of the first occurrence
+   * of the pattern, which all entries below the node share */
+  int score = 0;
+  fuzzy_match(search->pattern, search->key->str, &score);
+  if (search->found != NULL) {
+    g_array_append_val(search->found, node);
+  }
+
+  if (search->by_rank == true) {
+    size_t rank = trie_get_edge(node)->top;
+    while ((rank = trie_node_find_rank(node, rank, true)) != G_MAXSIZE) {
+      if (trie_fuzzy_spend(search) == true) {
+        return false;
+      }
+      if (search->match(rank, score, search->userdata) == false) {
+        break;
+      }
+    }
+    return true;
+  }
+
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, node, GIRARA_NODE_PRE_ORDER);
+  while ((node = girara_node_iter_next(&iter)) != NULL) {
+    const trie_edge_t* edge = trie_get_edge(node);
+    if (trie_fuzzy_spend(search) == true) {
+      return false;
+    }
+    if (edge->terminal == true && search->match(edge->rank, score, search->userdata) == false) {
+      break;
+    }
+  }
+  return true;
+}
+
+/* Search the subtree of a node, given the key up to the node and the number
+ * of characters of the pattern it matches. Returns false if the budget ran
+ * out. */
+static bool trie_fuzzy_walk(trie_fuzzy_search_t* search, girara_tree_node_t* start, size_t matched) {
+  const trie_fuzzy_level_t above = {.length = search->key->len, .matched = matched};
+  const size_t start_depth       = girara_node_get_depth(start);
+
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, start, GIRARA_NODE_PRE_ORDER);
+  girara_tree_node_t* node = NULL;
+  while ((node = girara_node_iter_next(&iter)) != NULL) {
+    if (trie_fuzzy_spend(search) == true) {
+      return false;
+    }
+
+    const trie_edge_t* edge         = trie_get_edge(node);
+    const size_t level              = girara_node_get_depth(node) - start_depth;
+    const trie_fuzzy_level_t parent = level != 0 ? g_array_index(search->levels, trie_fuzzy_level_t, level - 1) : above;
+
+    /* subtrees lacking some of the remaining characters cannot match */
+    const guint64 needed = search->remaining[parent.matched];
+    if (edge->top == 0 || (edge->mask & needed) != needed) {
+      girara_node_iter_skip_children(&iter);
+      continue;
+    }
+
+    g_string_truncate(search->key, parent.length);
+    g_string_append_len(search->key, edge->label, edge->length);
+    const trie_fuzzy_level_t current = {
+        .length  = search->key->len,
+        .matched = trie_fuzzy_advance(search->pattern, parent.matched, edge->label, edge->length),
+    };
+    if (current.matched == search->pattern->length) {
+      if (trie_fuzzy_report(search, node) == false) {
+        return false;
+      }
+      girara_node_iter_skip_children(&iter);
+      continue;
+    }
+
+    g_array_set_size(search->levels, level + 1);
+    g_array_index(search->levels, trie_fuzzy_level_t, level) = current;
+  }
+
+  return true;
+}
+
+bool trie_fuzzy_search(const girara_trie_t* trie, const fuzzy_pattern_t* pattern, const GArray* within, GArray* found,
+                       bool by_rank, size_t budget, trie_match_function_t match, void* userdata) {
+  trie_fuzzy_search_t search = {
+      .pattern   = pattern,
+      .remaining = g_new(guint64, pattern->length + 1),
+      .key       = g_string_new(NULL),
+      .levels    = g_array_new(FALSE, FALSE, sizeof(trie_fuzzy_level_t)),
+      .found     = found,
+      .by_rank   = by_rank,
+      .budget    = budget,
+      .match     = match,
+      .userdata  = userdata,
+  };
+  for (size_t idx = 0; idx <= pattern->length; ++idx) {
+    search.remaining[idx] = fuzzy_mask(pattern->text + idx);
+  }
+
+  bool done = true;
+  if (within == NULL) {
+    done = trie_fuzzy_walk(&search, trie->root, 0);
+  } else {
+    g_autoptr(GPtrArray) ancestors = g_ptr_array_new();
+    for (size_t idx = 0; idx != within->len && done == true; ++idx) {
+      girara_tree_node_t* node = g_array_index(within, girara_tree_node_t*, idx);
+
+      /* the key up to the node */
+      g_ptr_array_set_size(ancestors, 0);
+      for (girara_tree_node_t* parent = girara_node_get_parent(node); parent != NULL;
+           parent = girara_node_get_parent(parent)) {
+        g_ptr_array_add(ancestors, parent);
+      }
+      g_string_truncate(search.key, 0);
+      for (size_t level = ancestors->len; level-- != 0;) {
+        const trie_edge_t* edge = trie_get_edge(g_ptr_array_index(ancestors, level));
+        g_string_append_len(search.key, edge->label, edge->length);
+      }
+
+      done = trie_fuzzy_walk(&search, node, trie_fuzzy_advance(pattern, 0, search.key->str, search.key->len));
+    }
+  }
+
+  g_free(search.remaining);
+  g_string_free(search.key, TRUE);
+  g_array_unref(search.levels);
+  return done;
+}
+
+size_t girara_trie_memory_usage(const girara_trie_t* trie) {
+  g_return_val_if_fail(trie != NULL, 0);
+
+  size_t usage = sizeof(girara_trie_t) + trie->label_bytes;
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, trie->root, GIRARA_NODE_PRE_ORDER);
+  girara_tree_node_t* node = NULL;
+  while ((node = girara_node_iter_next(&iter)) != NULL) {
+    usage += node_memory_usage(node) + sizeof(trie_edge_t) + 1;
+  }
+
+  return usage;
+}
+
+girara_trie_iter_t* girara_trie_iter_new(const girara_trie_t* trie, const char* prefix) {
+  g_return_val_if_fail(trie != NULL && prefix != NULL, NULL);
+
+  girara_trie_iter_t* iter = g_try_malloc0(sizeof(girara_trie_iter_t));
+  if (iter == NULL) {
+    return NULL;
+  }
+
+  iter->key     = g_string_new(NULL);
+  iter->lengths = g_array_new(FALSE, FALSE, sizeof(size_t));
+
+  size_t offset            = 0;
+  girara_tree_node_t* node = trie_find(trie, prefix, &offset);
+  if (node == NULL) {
+    /* nothing to iterate */
+    girara_node_iter_init(&iter->nodes, NULL, GIRARA_NODE_PRE_ORDER);
+    return iter;
+  }
+
+  /* the key up to the first node, which may extend beyond the prefix */
+  g_string_append_len(iter->key, prefix, strlen(prefix) - offset);
+  iter->start_depth = girara_node_get_depth(node);
+  girara_node_iter_init(&iter->nodes, node, GIRARA_NODE_PRE_ORDER);
+
+  return iter;
+}
+
+bool girara_trie_iter_next(girara_trie_iter_t* iter, const char** key, void** value) {
+  g_return_val_if_fail(iter != NULL, false);
+
+  girara_tree_node_t* node = NULL;
+  while ((node = girara_node_iter_next(&iter->nodes)) != NULL) {
+    const trie_edge_t* edge = trie_get_edge(node);
+    const size_t level      = girara_node_get_depth(node) - iter->start_depth;
+
+    if (level != 0) {
+      g_string_truncate(iter->key, g_array_index(iter->lengths, size_t, level - 1));
+    }
+    g_string_append_len(iter->key, edge->label, edge->length);
+    g_array_set_size(iter->lengths, level + 1);
+    g_array_index(iter->lengths, size_t, level) = iter->key->len;
+
+    if (edge->terminal == true) {
+      if (key != NULL) {
+        *key = iter->key->str;
+      }
+      if (value != NULL) {
+        *value = edge->value;
+      }
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void girara_trie_iter_free(girara_trie_iter_t* iter) {
+  if (iter == NULL) {
+    return;
+  }
+
+  girara_node_iter_clear(&iter->nodes);
+  g_string_free(iter->key, TRUE);
+  g_array_unref(iter->lengths);
+  g_free(iter);
+}
@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <sys/types.h>
 #include <glib.h>
+#include <gio/gio.h>
 
 #include "macros.h"
 #include "types.h"
@@ -62,6 +63,40 @@ void girara_list_clear(girara_list_t* list) GIRARA_VISIBLE;
 
 G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC(girara_list_t, girara_list_clear)
 
+/**
+ * Remove all elements from a list but keep the allocated storage, so that
+ * refilling the list up to its previous size does not allocate. If a maximal
+ * retained capacity has been set with @ref
+ * girara_list_set_max_retained_capacity, storage exceeding it is released.
+ *
+ * @param list The girara list object
+ */
+void girara_list_reset(girara_list_t* list) GIRARA_VISIBLE;
+
+/**
+ * Set the maximal number of slots kept allocated by @ref girara_list_reset.
+ *
+ * @param list The girara list object
+ * @param capacity Maximal retained capacity or 0 for no limit
+ */
+void girara_list_set_max_retained_capacity(girara_list_t* list, size_t capacity) GIRARA_VISIBLE;
+
+/**
+ * Get the largest number of elements the list has ever held.
+ *
+ * @param list The girara list object
+ * @return The high-water mark of the list size
+ */
+size_t girara_list_high_water_mark(girara_list_t* list) GIRARA_VISIBLE;
+
+/**
+ * Get the number of elements the list can hold without allocating.
+ *
+ * @param list The girara list object
+ * @return The capacity of the list
+ */
+size_t girara_list_capacity(girara_list_t* list) GIRARA_VISIBLE;
+
 /**
  * Destroy list.
  *
@@ -147,6 +182,29 @@ ssize_t girara_list_position(girara_list_t* list, void* data) GIRARA_VISIBLE;
  */
 void girara_list_sort(girara_list_t* list, girara_compare_function_t compare) GIRARA_VISIBLE;
 
+/**
+ * Partially sort a list: afterwards the k smallest elements are stored in
+ * order at the front of the list, the order of the remaining elements is
+ * unspecified. Runs in O(n log k).
+ *
+ * @param list The list to sort
+ * @param k Number of elements to sort
+ * @param compare compare function
+ */
+void girara_list_partial_sort(girara_list_t* list, size_t k, girara_compare_function_t compare) GIRARA_VISIBLE;
+
+/**
+ * Select the nth smallest element of a list. Afterwards, the element is stored
+ * at position n, all elements before it compare less or equal and all
+ * elements after it compare greater or equal. Runs in O(n).
+ *
+ * @param list The list
+ * @param n Index of the element in sorted order
+ * @param compare compare function
+ * @return The nth smallest element or NULL if an error occurred
+ */
+void* girara_list_select_nth(girara_list_t* list, size_t n, girara_compare_function_t compare) GIRARA_VISIBLE;
+
 /**
  * Find an element
  *
@@ -157,6 +215,34 @@ void girara_list_sort(girara_list_t* list, girara_compare_function_t compare) GI
  */
 void* girara_list_find(const girara_list_t* list, girara_compare_function_t compare, const void* data) GIRARA_VISIBLE;
 
+/**
+ * Find the elements matching a batch of keys with a single pass over the
+ * list. compare is called with an element as first and a key as second
+ * argument, as for @ref girara_list_find, and the result is equivalent to
+ * calling @ref girara_list_find for every key.
+ *
+ * If the list is sorted with compare, the keys are looked up by binary search
+ * or merged with the list if they are sorted with compare as well. Otherwise,
+ * if hash is given, a hash table over the keys is built and every element of
+ * the list is looked up in it. Without hash, the list is scanned once per key.
+ *
+ * @param list The list
+ * @param compare compare function
+ * @param hash Hash function for the elements, or NULL. Elements and keys that
+ * compare equal need to have the same hash.
+ * @param key_hash Hash function for the keys, or NULL if hash accepts keys as
+ * well
+ * @param keys array of keys, passed as the second argument to the compare
+ * function
+ * @param n_keys number of keys
+ * @param results array of n_keys entries receiving the first matching element
+ * for each key or NULL
+ * @return the number of keys for which an element was found
+ */
+size_t girara_list_find_many(const girara_list_t* list, girara_compare_function_t compare, GHashFunc hash,
+                             GHashFunc key_hash, const void* const* keys, size_t n_keys,
+                             void** results) GIRARA_VISIBLE;
+
 /**
  * Create an iterator pointing at the start of list.
  *
@@ -273,6 +359,35 @@ girara_list_t* girara_list_merge(girara_list_t* list, girara_list_t* other) GIRA
  */
 girara_tree_node_t* girara_node_new(void* data) GIRARA_VISIBLE;
 
+/**
+ * Create a new node pool. Nodes allocated from a pool are carved out of
+ * contiguous slabs, and the slabs are released at once when the last node of
+ * the pool is freed. Pools are not thread-safe.
+ *
+ * @return A girara node pool or NULL if an error occurred
+ */
+girara_tree_pool_t* girara_tree_pool_new(void) GIRARA_VISIBLE;
+
+/**
+ * Free a node pool. If nodes allocated from the pool are still in use, the
+ * pool is released together with the last of them.
+ *
+ * @param pool The girara node pool
+ */
+void girara_tree_pool_free(girara_tree_pool_t* pool) GIRARA_VISIBLE;
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(girara_tree_pool_t, girara_tree_pool_free)
+
+/**
+ * Create a new node allocated from a pool. Nodes added with @ref
+ * girara_node_append_data are allocated from the same pool as their parent.
+ *
+ * @param pool The girara node pool or NULL to use the general-purpose allocator
+ * @param data Data of the new node
+ * @return A girara node object or NULL if an error occurred
+ */
+girara_tree_node_t* girara_node_new_in_pool(girara_tree_pool_t* pool, void* data) GIRARA_VISIBLE;
+
 /**
  * Set the function which should be called if the stored data should be freed.
  *
@@ -283,14 +398,69 @@ void girara_node_set_free_function(girara_tree_node_t* node, girara_free_functio
 
 /**
  * Free a node. This will remove the node from its' parent and will destroy all
- * its' children.
+ * its' children. The tree is destroyed without recursion, so arbitrarily deep
+ * trees can be freed.
  *
  * @param node The girara node object
  */
 void girara_node_free(girara_tree_node_t* node) GIRARA_VISIBLE;
 
+/**
+ * Free a node like @ref girara_node_free, but free independent subtrees
+ * concurrently. The free functions of the nodes need to be thread-safe and
+ * are called in an unspecified order.
+ *
+ * @param node The girara node object
+ * @param n_threads Maximal number of threads or 0 to use one per processor
+ */
+void girara_node_free_parallel(girara_tree_node_t* node, unsigned int n_threads) GIRARA_VISIBLE;
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(girara_tree_node_t, girara_node_free)
 
+/**
+ * Index returned by the flat tree functions if there is no such node, and
+ * parent index of the root in @ref girara_node_build and @ref
+ * girara_node_flatten.
+ */
+#define GIRARA_FLAT_TREE_NONE ((size_t)-1)
+
+/**
+ * Build a tree from parallel arrays in one pass. Node i has the data data[i]
+ * and is a child of node parent_index[i]. Node 0 is the root and has the parent
+ * index GIRARA_FLAT_TREE_NONE; all other nodes need to come after their parent.
+ * Siblings keep their relative order. All nodes are allocated in one batch.
+ *
+ * @param data The data of the nodes
+ * @param parent_index The parent indices of the nodes
+ * @param n The number of nodes
+ * @return The root of the tree or NULL if an error occurred
+ */
+girara_tree_node_t* girara_node_build(void* const* data, const size_t* parent_index, size_t n) GIRARA_VISIBLE;
+
+/**
+ * Build a tree like @ref girara_node_build and set the free function of all
+ * nodes.
+ *
+ * @param data The data of the nodes
+ * @param parent_index The parent indices of the nodes
+ * @param n The number of nodes
+ * @param gfree The free function
+ * @return The root of the tree or NULL if an error occurred
+ */
+girara_tree_node_t* girara_node_build_with_free(void* const* data, const size_t* parent_index, size_t n,
+                                                girara_free_function_t gfree) GIRARA_VISIBLE;
+
+/**
+ * Flatten a tree into parallel arrays of data and parent indices in pre-order,
+ * the inverse of @ref girara_node_build. The data is still owned by the tree.
+ *
+ * @param root The root of the tree
+ * @param data Return location for the data, free with g_free
+ * @param parent_index Return location for the parent indices, free with g_free
+ * @return The number of nodes or 0 if an error occurred
+ */
+size_t girara_node_flatten(girara_tree_node_t* root, void*** data, size_t** parent_index) GIRARA_VISIBLE;
+
 /**
  * Append a node to another node.
  *
@@ -299,6 +469,49 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(girara_tree_node_t, girara_node_free)
  */
 void girara_node_append(girara_tree_node_t* parent, girara_tree_node_t* child) GIRARA_VISIBLE;
 
+/**
+ * Prepend a node to another node.
+ *
+ * @param parent The parent node
+ * @param child The child node
+ */
+void girara_node_prepend(girara_tree_node_t* parent, girara_tree_node_t* child) GIRARA_VISIBLE;
+
+/**
+ * Insert a node before a sibling.
+ *
+ * @param sibling The sibling, which needs to have a parent
+ * @param node The node to insert
+ */
+void girara_node_insert_before(girara_tree_node_t* sibling, girara_tree_node_t* node) GIRARA_VISIBLE;
+
+/**
+ * Insert a node after a sibling.
+ *
+ * @param sibling The sibling, which needs to have a parent
+ * @param node The node to insert
+ */
+void girara_node_insert_after(girara_tree_node_t* sibling, girara_tree_node_t* node) GIRARA_VISIBLE;
+
+/**
+ * Detach a node and its subtree from its parent. The node becomes the root of
+ * a tree of its own, which keeps the key functions of the original tree.
+ *
+ * @param node The girara node object
+ */
+void girara_node_unlink(girara_tree_node_t* node) GIRARA_VISIBLE;
+
+/**
+ * Move a node and its subtree to a new parent. The new parent must not be in
+ * the subtree of the node.
+ *
+ * @param node The girara node object
+ * @param new_parent The new parent
+ * @param position Position among the children of the new parent, not counting
+ * the node itself; positions past the last child append the node
+ */
+void girara_node_move(girara_tree_node_t* node, girara_tree_node_t* new_parent, size_t position) GIRARA_VISIBLE;
+
 /**
  * Append data as new node to another node.
  *
@@ -317,13 +530,21 @@ girara_tree_node_t* girara_node_append_data(girara_tree_node_t* parent, void* da
 girara_tree_node_t* girara_node_get_parent(girara_tree_node_t* node) GIRARA_VISIBLE;
 
 /**
- * Get root node.
+ * Get root node. The root is cached in every node, so this is O(1).
  *
  * @param node The girara node object
  * @return The root node or NULL if an error occurred
  */
 girara_tree_node_t* girara_node_get_root(girara_tree_node_t* node) GIRARA_VISIBLE;
 
+/**
+ * Get depth of a node, i.e. its distance to the root node.
+ *
+ * @param node The girara node object
+ * @return The depth of the node
+ */
+size_t girara_node_get_depth(girara_tree_node_t* node) GIRARA_VISIBLE;
+
 /**
  * Get list of children.
  *
@@ -332,6 +553,55 @@ girara_tree_node_t* girara_node_get_root(girara_tree_node_t* node) GIRARA_VISIBL
  */
 girara_list_t* girara_node_get_children(girara_tree_node_t* node) GIRARA_VISIBLE;
 
+/**
+ * Call function for each child of a node. The callback may free the child it
+ * is called for.
+ *
+ * @param node The girara node object
+ * @param callback The function to call.
+ * @param userdata Passed to the callback as second argument.
+ */
+void girara_node_foreach_child(girara_tree_node_t* node, girara_node_callback_t callback,
+                               void* userdata) GIRARA_VISIBLE;
+
+/**
+ * Get first child. Together with @ref girara_node_get_next_sibling, this
+ * allows to iterate over the children without allocating:
+ *
+ *     for (girara_tree_node_t* child = girara_node_get_first_child(node); child != NULL;
+ *          child = girara_node_get_next_sibling(child)) {
+ *       ...
+ *     }
+ *
+ * @param node The girara node object
+ * @return The first child node or NULL if the node has no children
+ */
+girara_tree_node_t* girara_node_get_first_child(girara_tree_node_t* node) GIRARA_VISIBLE;
+
+/**
+ * Get last child.
+ *
+ * @param node The girara node object
+ * @return The last child node or NULL if the node has no children
+ */
+girara_tree_node_t* girara_node_get_last_child(girara_tree_node_t* node) GIRARA_VISIBLE;
+
+/**
+ * Get next sibling.
+ *
+ * @param node The girara node object
+ * @return The next sibling or NULL if the node is the last child
+ */
+girara_tree_node_t* girara_node_get_next_sibling(girara_tree_node_t* node) GIRARA_VISIBLE;
+
+/**
+ * Get previous sibling.
+ *
+ * @param node The girara node object
+ * @return The previous sibling or NULL if the node is the first child
+ */
+girara_tree_node_t* girara_node_get_previous_sibling(girara_tree_node_t* node) GIRARA_VISIBLE;
+
 /**
  * Get number of children.
  *
@@ -340,6 +610,161 @@ girara_list_t* girara_node_get_children(girara_tree_node_t* node) GIRARA_VISIBLE
  */
 size_t girara_node_get_num_children(girara_tree_node_t* node) GIRARA_VISIBLE;
 
+/**
+ * Order in which a tree is traversed.
+ */
+typedef enum girara_node_traverse_order_e {
+  GIRARA_NODE_PRE_ORDER,   /**< Visit a node before its children */
+  GIRARA_NODE_POST_ORDER,  /**< Visit a node after its children */
+  GIRARA_NODE_LEVEL_ORDER, /**< Visit all nodes of a level before the next level */
+} girara_node_traverse_order_t;
+
+/**
+ * Result of a traversal callback.
+ */
+typedef enum girara_node_traverse_result_e {
+  GIRARA_NODE_TRAVERSE_CONTINUE,      /**< Continue the traversal */
+  GIRARA_NODE_TRAVERSE_SKIP_CHILDREN, /**< Do not visit the children of the node */
+  GIRARA_NODE_TRAVERSE_STOP,          /**< Stop the traversal */
+} girara_node_traverse_result_t;
+
+/**
+ * Function declaration of a function called for every node during a
+ * traversal.
+ *
+ * @param node the current node.
+ * @param userdata data passed as userdata to @ref girara_node_traverse.
+ * @return how to continue the traversal
+ */
+typedef girara_node_traverse_result_t (*girara_node_traverse_function_t)(girara_tree_node_t* node, void* userdata);
+
+/**
+ * Iterator over all nodes of a tree. It is meant to be allocated on the
+ * stack; all members are private.
+ *
+ *     girara_node_iter_t iter;
+ *     girara_node_iter_init(&iter, root, GIRARA_NODE_PRE_ORDER);
+ *     girara_tree_node_t* node = NULL;
+ *     while ((node = girara_node_iter_next(&iter)) != NULL) {
+ *       ...
+ *     }
+ *     girara_node_iter_clear(&iter);
+ *
+ * Pre- and post-order traversals only follow the links of the nodes and never
+ * allocate. Level-order traversals use a single queue of nodes whose children
+ * are still to be visited.
+ */
+typedef struct girara_node_iter_s {
+  girara_tree_node_t* root;           /**< The root of the traversal */
+  girara_tree_node_t* current;        /**< The last visited node */
+  girara_tree_node_t* sibling;        /**< Next node on the current level */
+  girara_tree_node_t** queue;         /**< Ring buffer of nodes with unvisited children */
+  size_t queue_head;                  /**< First element of the queue */
+  size_t queue_size;                  /**< Number of elements in the queue */
+  size_t queue_capacity;              /**< Capacity of the queue */
+  girara_node_traverse_order_t order; /**< The traversal order */
+  bool skip_children;                 /**< Skip the children of the current node */
+  bool done;                          /**< The traversal is finished */
+  bool failed;                        /**< The traversal stopped since the queue could not grow */
+} girara_node_iter_t;
+
+/**
+ * Initialize a tree iterator.
+ *
+ * @param iter The iterator
+ * @param root The root of the tree or subtree to traverse
+ * @param order The traversal order
+ */
+void girara_node_iter_init(girara_node_iter_t* iter, girara_tree_node_t* root,
+                           girara_node_traverse_order_t order) GIRARA_VISIBLE;
+
+/**
+ * Advance a tree iterator. The tree must not be modified during the
+ * traversal.
+ *
+ * @param iter The iterator
+ * @return The next node or NULL if all nodes have been visited or the
+ * traversal failed, see @ref girara_node_iter_failed
+ */
+girara_tree_node_t* girara_node_iter_next(girara_node_iter_t* iter) GIRARA_VISIBLE;
+
+/**
+ * Check whether a traversal ended before all nodes were visited because
+ * memory for the queue of a level-order traversal could not be allocated.
+ *
+ * @param iter The iterator
+ * @return true if the traversal failed
+ */
+bool girara_node_iter_failed(const girara_node_iter_t* iter) GIRARA_VISIBLE;
+
+/**
+ * Do not visit the children of the node last returned by @ref
+ * girara_node_iter_next. This has no effect for post-order traversals.
+ *
+ * @param iter The iterator
+ */
+void girara_node_iter_skip_children(girara_node_iter_t* iter) GIRARA_VISIBLE;
+
+/**
+ * Release the resources held by a tree iterator. The traversal may be stopped
+ * at any point by clearing the iterator.
+ *
+ * @param iter The iterator
+ */
+void girara_node_iter_clear(girara_node_iter_t* iter) GIRARA_VISIBLE;
+
+G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC(girara_node_iter_t, girara_node_iter_clear)
+
+/**
+ * Call function for every node of a tree.
+ *
+ * @param root The root of the tree or subtree to traverse
+ * @param order The traversal order
+ * @param callback The function to call. Its result decides whether the
+ * traversal continues, skips the children of the node or stops.
+ * @param userdata Passed to the callback as second argument.
+ * @return false if the traversal was stopped by the callback or failed to
+ * allocate memory, true otherwise
+ */
+bool girara_node_traverse(girara_tree_node_t* root, girara_node_traverse_order_t order,
+                          girara_node_traverse_function_t callback, void* userdata) GIRARA_VISIBLE;
+
+/**
+ * Set the functions used to compare the data of nodes with keys in @ref
+ * girara_node_find_child. They apply to the whole tree. If no key function is
+ * set, the data pointers are compared directly.
+ *
+ * @param root The root node of the tree
+ * @param hash Hash function for the data and the keys, or NULL to compare
+ * pointers
+ * @param equal Function comparing the data of a node (first argument) with a
+ * key (second argument), or NULL to compare pointers
+ */
+void girara_node_set_key_function(girara_tree_node_t* root, GHashFunc hash, GEqualFunc equal) GIRARA_VISIBLE;
+
+/**
+ * Find the first child whose data matches a key. Nodes with many children
+ * keep a hash table of their children, so the lookup is O(1) independent of
+ * the number of children.
+ *
+ * @param node The girara node object
+ * @param key The key
+ * @return The child or NULL if no child matches the key
+ */
+girara_tree_node_t* girara_node_find_child(girara_tree_node_t* node, const void* key) GIRARA_VISIBLE;
+
+/**
+ * Follow a path of keys starting at a node, looking up each key with @ref
+ * girara_node_find_child.
+ *
+ * @param root The node where the path starts
+ * @param keys The keys
+ * @param n The number of keys
+ * @return The node at the end of the path or NULL if the path does not exist
+ */
+girara_tree_node_t* girara_node_find_path(girara_tree_node_t* root, const void* const* keys,
+                                          size_t n) GIRARA_VISIBLE;
+
 /**
  * Get data.
  *
@@ -356,4 +781,309 @@ void* girara_node_get_data(girara_tree_node_t* node) GIRARA_VISIBLE;
  */
 void girara_node_set_data(girara_tree_node_t* node, void* data) GIRARA_VISIBLE;
 
+/**
+ * Freeze a tree into a compact read-only flat tree. The nodes are stored in
+ * pre-order in contiguous arrays and are addressed by their index; the root
+ * has index 0. The flat tree takes over the data of the nodes and frees it with
+ * the free function of the root, so all nodes need to share the same free
+ * function. Afterwards the tree can be freed without affecting the flat tree.
+ *
+ * @param root The root of the tree
+ * @return The flat tree or NULL if an error occurred
+ */
+girara_flat_tree_t* girara_node_freeze(girara_tree_node_t* root) GIRARA_VISIBLE;
+
+/**
+ * Destroys a flat tree and frees the data of its nodes.
+ *
+ * @param tree The flat tree
+ */
+void girara_flat_tree_free(girara_flat_tree_t* tree) GIRARA_VISIBLE;
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(girara_flat_tree_t, girara_flat_tree_free)
+
+/**
+ * Returns the number of nodes of a flat tree.
+ *
+ * @param tree The flat tree
+ * @return The number of nodes
+ */
+size_t girara_flat_tree_size(const girara_flat_tree_t* tree) GIRARA_VISIBLE;
+
+/**
+ * Get the data of a node.
+ *
+ * @param tree The flat tree
+ * @param index The index of the node
+ * @return The data of the node
+ */
+void* girara_flat_tree_get_data(const girara_flat_tree_t* tree, size_t index) GIRARA_VISIBLE;
+
+/**
+ * Get the parent of a node in O(1).
+ *
+ * @param tree The flat tree
+ * @param index The index of the node
+ * @return The index of the parent or GIRARA_FLAT_TREE_NONE for the root
+ */
+size_t girara_flat_tree_get_parent(const girara_flat_tree_t* tree, size_t index) GIRARA_VISIBLE;
+
+/**
+ * Get the first child of a node in O(1).
+ *
+ * @param tree The flat tree
+ * @param index The index of the node
+ * @return The index of the first child or GIRARA_FLAT_TREE_NONE if the node
+ * has no children
+ */
+size_t girara_flat_tree_get_first_child(const girara_flat_tree_t* tree, size_t index) GIRARA_VISIBLE;
+
+/**
+ * Get the next sibling of a node in O(1).
+ *
+ * @param tree The flat tree
+ * @param index The index of the node
+ * @return The index of the next sibling or GIRARA_FLAT_TREE_NONE if the node
+ * is the last child
+ */
+size_t girara_flat_tree_get_next_sibling(const girara_flat_tree_t* tree, size_t index) GIRARA_VISIBLE;
+
+/**
+ * Get the number of nodes in the subtree of a node, including the node itself.
+ *
+ * @param tree The flat tree
+ * @param index The index of the node
+ * @return The size of the subtree
+ */
+size_t girara_flat_tree_get_subtree_size(const girara_flat_tree_t* tree, size_t index) GIRARA_VISIBLE;
+
+/**
+ * Skip the subtree of a node in O(1). The returned index is the next node in
+ * pre-order which is not a descendant of the node, or the size of the tree if
+ * there is none.
+ *
+ * @param tree The flat tree
+ * @param index The index of the node
+ * @return The index of the next node after the subtree
+ */
+size_t girara_flat_tree_skip_subtree(const girara_flat_tree_t* tree, size_t index) GIRARA_VISIBLE;
+
+/**
+ * Calls a function for the data of each node of the flat tree in pre-order.
+ *
+ * @param tree The flat tree
+ * @param callback The function to call
+ * @param userdata Passed as second argument to the callback
+ */
+void girara_flat_tree_foreach(const girara_flat_tree_t* tree, girara_list_callback_t callback,
+                              void* userdata) GIRARA_VISIBLE;
+
+/**
+ * Error domain of the tree serialization functions.
+ */
+#define GIRARA_TREE_ERROR girara_tree_error_quark()
+
+GQuark girara_tree_error_quark(void) GIRARA_VISIBLE;
+
+/**
+ * Error codes of the tree serialization functions.
+ */
+typedef enum girara_tree_error_e {
+  GIRARA_TREE_ERROR_INVALID_FORMAT, /**< The input is not a valid serialized tree */
+  GIRARA_TREE_ERROR_VERSION,        /**< The format version is not supported */
+  GIRARA_TREE_ERROR_CHECKSUM,       /**< The checksum does not match */
+  GIRARA_TREE_ERROR_DATA,           /**< The data of a node could not be serialized */
+} girara_tree_error_t;
+
+/**
+ * Function declaration of a function that serializes the data of a node by
+ * appending it to a buffer.
+ *
+ * @param data The data of the node
+ * @param buffer The buffer to append to
+ * @param userdata Userdata
+ * @return true on success, false otherwise
+ */
+typedef bool (*girara_node_data_writer_t)(const void* data, GByteArray* buffer, void* userdata);
+
+/**
+ * Function declaration of a function that creates the data of a node from its
+ * serialized form. The bytes stay valid for the lifetime of the flat tree, so
+ * the data may point into them.
+ *
+ * @param bytes The serialized data, aligned to 8 bytes
+ * @param length The length of the serialized data
+ * @param userdata Userdata
+ * @return The data of the node
+ */
+typedef void* (*girara_node_data_reader_t)(const void* bytes, size_t length, void* userdata);
+
+/**
+ * Serialize a tree in a compact binary format. The format has a versioned
+ * header and a checksum and can be loaded as flat tree with @ref
+ * girara_flat_tree_load.
+ *
+ * @param root The root of the tree
+ * @param stream The stream to write to
+ * @param writer Function serializing the data of a node
+ * @param userdata Passed to the writer
+ * @param error Return location for an error
+ * @return true on success, false otherwise
+ */
+bool girara_node_serialize(girara_tree_node_t* root, GOutputStream* stream, girara_node_data_writer_t writer,
+                           void* userdata, GError** error) GIRARA_VISIBLE;
+
+/**
+ * Load a serialized tree as flat tree. The file is memory-mapped and the
+ * parent indices of the nodes are copied into the flat tree, which computes
+ * the subtree sizes from them. Without reader, the data of the nodes points
+ * directly into the mapped file and is not copied.
+ *
+ * @param path The path of the file
+ * @param reader Function creating the data of a node, or NULL to reference
+ * the serialized data
+ * @param userdata Passed to the reader
+ * @param gfree Free function for the data created by the reader; needs to be
+ * NULL if there is no reader
+ * @param error Return location for an error
+ * @return The flat tree or NULL if an error occurred
+ */
+girara_flat_tree_t* girara_flat_tree_load(const char* path, girara_node_data_reader_t reader, void* userdata,
+                                          girara_free_function_t gfree, GError** error) GIRARA_VISIBLE;
+
+/**
+ * Load a serialized tree from memory like @ref girara_flat_tree_load. The flat
+ * tree keeps a reference to the bytes.
+ *
+ * @param bytes The serialized tree
+ * @param reader Function creating the data of a node, or NULL to reference
+ * the serialized data
+ * @param userdata Passed to the reader
+ * @param gfree Free function for the data created by the reader; needs to be
+ * NULL if there is no reader
+ * @param error Return location for an error
+ * @return The flat tree or NULL if an error occurred
+ */
+girara_flat_tree_t* girara_flat_tree_load_bytes(GBytes* bytes, girara_node_data_reader_t reader, void* userdata,
+                                                girara_free_function_t gfree, GError** error) GIRARA_VISIBLE;
+
+/**
+ * Create a new radix trie mapping strings to values.
+ *
+ * @return The trie or NULL if an error occurred
+ */
+girara_trie_t* girara_trie_new(void) GIRARA_VISIBLE;
+
+/**
+ * Create a new radix trie with a free function for the values.
+ *
+ * @param gfree Free function for the values
+ * @return The trie or NULL if an error occurred
+ */
+girara_trie_t* girara_trie_new_with_free(girara_free_function_t gfree) GIRARA_VISIBLE;
+
+/**
+ * Destroy a trie and all its values.
+ *
+ * @param trie The trie
+ */
+void girara_trie_free(girara_trie_t* trie) GIRARA_VISIBLE;
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(girara_trie_t, girara_trie_free)
+
+/**
+ * Insert an entry. If the key is already present, its value is replaced and
+ * the old value is freed.
+ *
+ * @param trie The trie
+ * @param key The key, which is copied
+ * @param value The value
+ * @return true if the key was not present before, false otherwise
+ */
+bool girara_trie_insert(girara_trie_t* trie, const char* key, void* value) GIRARA_VISIBLE;
+
+/**
+ * Remove an entry and free its value.
+ *
+ * @param trie The trie
+ * @param key The key
+ * @return true if the key was present, false otherwise
+ */
+bool girara_trie_remove(girara_trie_t* trie, const char* key) GIRARA_VISIBLE;
+
+/**
+ * Check if the trie contains a key.
+ *
+ * @param trie The trie
+ * @param key The key
+ * @return true if the key is present, false otherwise
+ */
+bool girara_trie_contains(const girara_trie_t* trie, const char* key) GIRARA_VISIBLE;
+
+/**
+ * Get the value of a key.
+ *
+ * @param trie The trie
+ * @param key The key
+ * @return The value or NULL if the key is not present
+ */
+void* girara_trie_lookup(const girara_trie_t* trie, const char* key) GIRARA_VISIBLE;
+
+/**
+ * Get the number of entries.
+ *
+ * @param trie The trie
+ * @return The number of entries
+ */
+size_t girara_trie_size(const girara_trie_t* trie) GIRARA_VISIBLE;
+
+/**
+ * Get the number of entries whose keys start with a prefix. The counts are
+ * maintained on every insertion and removal, so this does not enumerate the
+ * entries.
+ *
+ * @param trie The trie
+ * @param prefix The prefix
+ * @return The number of matching entries
+ */
+size_t girara_trie_count_prefix(const girara_trie_t* trie, const char* prefix) GIRARA_VISIBLE;
+
+/**
+ * Estimate the memory used by the trie, excluding the values.
+ *
+ * @param trie The trie
+ * @return The size in bytes
+ */
+size_t girara_trie_memory_usage(const girara_trie_t* trie) GIRARA_VISIBLE;
+
+/**
+ * Create an iterator over all entries whose keys start with a prefix. The
+ * entries are produced on demand in depth-first order. The trie must not be
+ * modified while the iterator is in use.
+ *
+ * @param trie The trie
+ * @param prefix The prefix
+ * @return The iterator or NULL if an error occurred
+ */
+girara_trie_iter_t* girara_trie_iter_new(const girara_trie_t* trie, const char* prefix) GIRARA_VISIBLE;
+
+/**
+ * Advance the iterator to the next entry.
+ *
+ * @param iter The trie iterator
+ * @param key Return location for the key, which is valid until the next call
+ * @param value Return location for the value
+ * @return true if there was another entry, false otherwise
+ */
+bool girara_trie_iter_next(girara_trie_iter_t* iter, const char** key, void** value) GIRARA_VISIBLE;
+
+/**
+ * Destroy the iterator.
+ *
+ * @param iter The trie iterator
+ */
+void girara_trie_iter_free(girara_trie_iter_t* iter) GIRARA_VISIBLE;
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(girara_trie_iter_t, girara_trie_iter_free)
+
 #endif
@@ -7,6 +7,7 @@
 
 #include "datastructures.h"
 #include "input-history.h"
+#include "input-history-file-io.h"
 #include "log.h"
 #include "template.h"
 #include "utils.h"
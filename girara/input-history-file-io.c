@@ -0,0 +1,809 @@
+/* SPDX-License-Identifier: Zlib */
+
+#include "input-history-file-io.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "datastructures.h"
+#include "log.h"
+
+/* Cursors combine the offset after the read lines with the generation of the
+ * file, which changes whenever the file is rewritten. */
+#define FILE_IO_OFFSET_BITS 48
+#define FILE_IO_OFFSET_MASK ((G_GUINT64_CONSTANT(1) << FILE_IO_OFFSET_BITS) - 1)
+
+/**
+ * Private data of the input history file storage
+ */
+typedef struct ih_file_io_private_s {
+  char* path;
+  guint max_entries;     /**< Maximal number of inputs kept when compacting, 0 for no limit */
+  bool shared;           /**< The file is shared with other processes */
+  int fd;                /**< File descriptor used for appending, -1 if not opened yet */
+  guint64 generation;    /**< Number of times the file was rewritten plus one */
+  dev_t device;          /**< Device of the file last read */
+  ino_t inode;           /**< Inode of the file last read, 0 if unknown */
+  size_t lines;          /**< Number of lines in the file as far as known */
+  size_t length;         /**< Length of the file as far as known */
+  GHashTable* evicted;   /**< Inputs that were evicted from the input history */
+  bool compacting;       /**< The file is being rewritten */
+  GFileMonitor* monitor; /**< Monitor for changes by other processes */
+} GiraraInputHistoryFileIOPrivate;
+
+static void ih_file_io_iface_init(GiraraInputHistoryIOInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(GiraraInputHistoryFileIO, girara_input_history_file_io, G_TYPE_OBJECT,
+                        G_ADD_PRIVATE(GiraraInputHistoryFileIO)
+                            G_IMPLEMENT_INTERFACE(GIRARA_TYPE_INPUT_HISTORY_IO, ih_file_io_iface_init))
+
+/* Methods */
+static void ih_file_io_constructed(GObject* object);
+static void ih_file_io_dispose(GObject* object);
+static void ih_file_io_finalize(GObject* object);
+static void ih_file_io_set_property(GObject* object, guint prop_id, const GValue* value, GParamSpec* pspec);
+static void ih_file_io_get_property(GObject* object, guint prop_id, GValue* value, GParamSpec* pspec);
+
+/* Properties */
+enum {
+  PROP_0,
+  PROP_PATH,
+  PROP_MAX_ENTRIES,
+  PROP_SHARED,
+};
+
+/* Class init */
+static void girara_input_history_file_io_class_init(GiraraInputHistoryFileIOClass* class) {
+  /* overwrite methods */
+  GObjectClass* object_class = G_OBJECT_CLASS(class);
+  object_class->constructed  = ih_file_io_constructed;
+  object_class->dispose      = ih_file_io_dispose;
+  object_class->finalize     = ih_file_io_finalize;
+  object_class->set_property = ih_file_io_set_property;
+  object_class->get_property = ih_file_io_get_property;
+
+  /* properties */
+  g_object_class_install_property(object_class, PROP_PATH,
+                                  g_param_spec_string("path", "path", "Path of the history file", NULL,
+                                                      G_PARAM_WRITABLE | G_PARAM_READABLE | G_PARAM_CONSTRUCT_ONLY |
+                                                          G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property(
+      object_class, PROP_MAX_ENTRIES,
+      g_param_spec_uint("max-entries", "maximal number of entries",
+                        "Maximal number of inputs kept when compacting the file; 0 for no limit", 0, G_MAXUINT, 0,
+                        G_PARAM_WRITABLE | G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property(
+      object_class, PROP_SHARED,
+      g_param_spec_boolean("shared", "shared", "Share the history file with other processes", FALSE,
+                           G_PARAM_WRITABLE | G_PARAM_READABLE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS));
+}
+
+/* Object init */
+static void girara_input_history_file_io_init(GiraraInputHistoryFileIO* io) {
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+  priv->fd                              = -1;
+  priv->generation                      = 1;
+  priv->evicted                         = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+}
+
+static void ih_file_io_file_changed(GFileMonitor* monitor, GFile* file, GFile* other, GFileMonitorEvent event,
+                                    gpointer data);
+
+/* GObject constructed */
+static void ih_file_io_constructed(GObject* object) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(object);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  G_OBJECT_CLASS(girara_input_history_file_io_parent_class)->constructed(object);
+
+  if (priv->shared == true && priv->path != NULL) {
+    g_autoptr(GFile) file   = g_file_new_for_path(priv->path);
+    g_autoptr(GError) error = NULL;
+    priv->monitor           = g_file_monitor_file(file, G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+    if (priv->monitor == NULL) {
+      girara_warning("Failed to monitor history file '%s': %s", priv->path, error->message);
+      return;
+    }
+
+    g_file_monitor_set_rate_limit(priv->monitor, 100);
+    g_signal_connect(priv->monitor, "changed", G_CALLBACK(ih_file_io_file_changed), io);
+  }
+}
+
+static void ih_file_io_close(GiraraInputHistoryFileIOPrivate* priv) {
+  if (priv->fd != -1) {
+    g_close(priv->fd, NULL);
+    priv->fd = -1;
+  }
+}
+
+/* GObject dispose */
+static void ih_file_io_dispose(GObject* object) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(object);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  if (priv->monitor != NULL) {
+    g_signal_handlers_disconnect_by_data(priv->monitor, io);
+    g_file_monitor_cancel(priv->monitor);
+    g_clear_object(&priv->monitor);
+  }
+  ih_file_io_close(priv);
+
+  G_OBJECT_CLASS(girara_input_history_file_io_parent_class)->dispose(object);
+}
+
+/* GObject finalize */
+static void ih_file_io_finalize(GObject* object) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(object);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  g_hash_table_destroy(priv->evicted);
+  g_free(priv->path);
+
+  G_OBJECT_CLASS(girara_input_history_file_io_parent_class)->finalize(object);
+}
+
+/* GObject set_property */
+static void ih_file_io_set_property(GObject* object, guint prop_id, const GValue* value, GParamSpec* pspec) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(object);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  switch (prop_id) {
+  case PROP_PATH:
+    g_free(priv->path);
+    priv->path = g_value_dup_string(value);
+    break;
+  case PROP_MAX_ENTRIES:
+    priv->max_entries = g_value_get_uint(value);
+    break;
+  case PROP_SHARED:
+    priv->shared = g_value_get_boolean(value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+  }
+}
+
+/* GObject get_property */
+static void ih_file_io_get_property(GObject* object, guint prop_id, GValue* value, GParamSpec* pspec) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(object);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  switch (prop_id) {
+  case PROP_PATH:
+    g_value_set_string(value, priv->path);
+    break;
+  case PROP_MAX_ENTRIES:
+    g_value_set_uint(value, priv->max_entries);
+    break;
+  case PROP_SHARED:
+    g_value_set_boolean(value, priv->shared);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+  }
+}
+
+/* Object new */
+GiraraInputHistoryFileIO* girara_input_history_file_io_new(const char* path) {
+  g_return_val_if_fail(path != NULL, NULL);
+  return GIRARA_INPUT_HISTORY_FILE_IO(g_object_new(GIRARA_TYPE_INPUT_HISTORY_FILE_IO, "path", path, NULL));
+}
+
+GiraraInputHistoryFileIO* girara_input_history_file_io_new_shared(const char* path) {
+  g_return_val_if_fail(path != NULL, NULL);
+  return GIRARA_INPUT_HISTORY_FILE_IO(
+      g_object_new(GIRARA_TYPE_INPUT_HISTORY_FILE_IO, "path", path, "shared", TRUE, NULL));
+}
+
+/* Helpers */
+
+static void ih_file_set_error(GError** error, int errsv) {
+  g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(errsv), "%s", g_strerror(errsv));
+}
+
+static bool ih_file_write_all(int fd, const char* data, size_t length, GError** error) {
+  while (length != 0) {
+    const ssize_t written = write(fd, data, length);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ih_file_set_error(error, errno);
+      return false;
+    }
+    data += written;
+    length -= written;
+  }
+
+  return true;
+}
+
+static size_t ih_file_count_lines(const char* data, size_t length) {
+  size_t count = 0;
+  for (const char* end = data + length; data != end; ++count) {
+    const char* newline = memchr(data, '\n', end - data);
+    if (newline == NULL) {
+      break;
+    }
+    data = newline + 1;
+  }
+
+  return count;
+}
+
+/**
+ * Lines read from the file share one allocation. Every line is preceded by a
+ * pointer to it, and the allocation is released together with the last line.
+ */
+typedef struct ih_file_lines_s {
+  size_t references; /**< Number of lines not freed yet */
+} ih_file_lines_t;
+
+static void ih_file_line_free(void* data) {
+  ih_file_lines_t* lines = NULL;
+  memcpy(&lines, (char*)data - sizeof(lines), sizeof(lines));
+  if (--lines->references == 0) {
+    g_free(lines);
+  }
+}
+
+/* Split the complete lines of the data into a list of inputs. */
+static girara_list_t* ih_file_split(const char* data, size_t length, size_t* consumed) {
+  girara_list_t* list = girara_list_new_with_free(ih_file_line_free);
+  const char* end     = data + length;
+  while (end != data && end[-1] != '\n') {
+    --end;
+  }
+  *consumed = end - data;
+
+  const size_t count = ih_file_count_lines(data, *consumed);
+  if (count == 0) {
+    return list;
+  }
+
+  ih_file_lines_t* lines = g_malloc(sizeof(ih_file_lines_t) + count * sizeof(lines) + *consumed);
+  lines->references      = count;
+  char* copy             = (char*)(lines + 1);
+  for (const char* line = data; line != end;) {
+    const char* newline = memchr(line, '\n', end - line);
+    const size_t size   = newline - line;
+    memcpy(copy, &lines, sizeof(lines));
+    copy += sizeof(lines);
+    memcpy(copy, line, size);
+    copy[size] = '\0';
+    girara_list_append(list, copy);
+
+    copy += size + 1;
+    line = newline + 1;
+  }
+
+  return list;
+}
+
+/* Open the file for appending. A shared file is locked as well, and since
+ * another process might have replaced it while waiting for the lock, it is
+ * reopened until the locked file is the one at the path. */
+static bool ih_file_io_acquire(GiraraInputHistoryFileIOPrivate* priv, GError** error) {
+  while (true) {
+    if (priv->fd == -1) {
+      priv->fd = g_open(priv->path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+      if (priv->fd == -1) {
+        ih_file_set_error(error, errno);
+        return false;
+      }
+    }
+    if (priv->shared == false) {
+      return true;
+    }
+
+    if (flock(priv->fd, LOCK_EX) != 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ih_file_set_error(error, errno);
+      return false;
+    }
+
+    struct stat locked;
+    struct stat current;
+    if (fstat(priv->fd, &locked) != 0) {
+      ih_file_set_error(error, errno);
+      ih_file_io_close(priv);
+      return false;
+    }
+    if (stat(priv->path, &current) == 0) {
+      if (locked.st_dev == current.st_dev && locked.st_ino == current.st_ino) {
+        return true;
+      }
+    } else if (errno != ENOENT) {
+      ih_file_set_error(error, errno);
+      ih_file_io_close(priv);
+      return false;
+    }
+
+    /* closing the file also releases the lock */
+    ih_file_io_close(priv);
+  }
+}
+
+static void ih_file_io_release(GiraraInputHistoryFileIOPrivate* priv) {
+  if (priv->shared == true && priv->fd != -1) {
+    flock(priv->fd, LOCK_UN);
+  }
+}
+
+static void ih_file_io_compacted(GObject* source, GAsyncResult* result, gpointer GIRARA_UNUSED(data)) {
+  GiraraInputHistoryFileIO* io = GIRARA_INPUT_HISTORY_FILE_IO(source);
+
+  g_autoptr(GError) error = NULL;
+  if (girara_input_history_file_io_compact_finish(io, result, &error) == false &&
+      g_error_matches(error, G_IO_ERROR, G_IO_ERROR_PENDING) == FALSE) {
+    GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+    girara_warning("Failed to compact history file '%s': %s", priv->path, error->message);
+  }
+}
+
+/* Start compacting once the file holds twice the inputs to keep, or evicted
+ * inputs make up half of the lines. */
+static void ih_file_io_maybe_compact(GiraraInputHistoryFileIO* io) {
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+  if (priv->compacting == true) {
+    return;
+  }
+
+  const size_t evicted = g_hash_table_size(priv->evicted);
+  if ((priv->max_entries != 0 && priv->lines > 2 * (size_t)priv->max_entries) ||
+      (evicted != 0 && 2 * evicted >= priv->lines)) {
+    girara_input_history_file_io_compact_async(io, NULL, ih_file_io_compacted, NULL);
+  }
+}
+
+/* Whether a file is the one last read. */
+static bool ih_file_io_is_same(GiraraInputHistoryFileIOPrivate* priv, const struct stat* info) {
+  return priv->inode != 0 && info->st_dev == priv->device && info->st_ino == priv->inode;
+}
+
+/* Write complete lines with a single write. If the file ends at the cursor,
+ * the cursor is moved past the lines. */
+static void ih_file_io_write(GiraraInputHistoryFileIO* io, GString* data, size_t count, guint64* cursor) {
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+  if (count == 0) {
+    return;
+  }
+
+  g_autoptr(GError) error = NULL;
+  if (ih_file_io_acquire(priv, &error) == false) {
+    girara_warning("Failed to open history file '%s': %s", priv->path, error->message);
+    return;
+  }
+
+  struct stat info;
+  const bool same_file = fstat(priv->fd, &info) == 0 && ih_file_io_is_same(priv, &info);
+  const bool at_cursor = same_file == true && cursor != NULL &&
+                         *cursor == (priv->generation << FILE_IO_OFFSET_BITS | (guint64)info.st_size);
+  const bool known     = same_file == true && (size_t)info.st_size == priv->length;
+  const bool written   = ih_file_write_all(priv->fd, data->str, data->len, &error);
+  ih_file_io_release(priv);
+  if (written == false) {
+    girara_warning("Failed to write history file '%s': %s", priv->path, error->message);
+    return;
+  }
+
+  if (at_cursor == true) {
+    *cursor += data->len;
+  }
+  if (known == true) {
+    /* the monitor does not report own writes as changes */
+    priv->length += data->len;
+  }
+
+  priv->lines += count;
+  ih_file_io_maybe_compact(io);
+}
+
+/* Append an input as line. Returns false if it cannot be stored. */
+static bool ih_file_io_add_line(GiraraInputHistoryFileIOPrivate* priv, GString* data, const char* input) {
+  if (input == NULL) {
+    return false;
+  }
+  if (strchr(input, '\n') != NULL) {
+    girara_warning("Ignoring input history entry spanning several lines");
+    return false;
+  }
+
+  g_string_append(data, input);
+  g_string_append_c(data, '\n');
+  /* an input that is appended again is no longer evicted */
+  g_hash_table_remove(priv->evicted, input);
+  return true;
+}
+
+/* Interface methods */
+
+static void ih_file_io_append(GiraraInputHistoryIO* object, const char* input) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(object);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  g_autoptr(GString) data = g_string_new(NULL);
+  if (ih_file_io_add_line(priv, data, input) == true) {
+    ih_file_io_write(io, data, 1, NULL);
+  }
+}
+
+static void ih_file_io_append_batch(GiraraInputHistoryIO* object, girara_list_t* inputs, guint64* cursor) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(object);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  g_autoptr(GString) data = g_string_new(NULL);
+  size_t count            = 0;
+  for (size_t idx = 0; idx != girara_list_size(inputs); ++idx) {
+    if (ih_file_io_add_line(priv, data, girara_list_nth(inputs, idx)) == true) {
+      ++count;
+    }
+  }
+  ih_file_io_write(io, data, count, cursor);
+}
+
+static girara_list_t* ih_file_io_read_since(GiraraInputHistoryIO* object, guint64* cursor, bool* reload) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(object);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  const int fd = g_open(priv->path, O_RDONLY | O_CLOEXEC, 0);
+  struct stat info;
+  if (fd == -1 || fstat(fd, &info) != 0) {
+    const int errsv = errno;
+    if (errsv != ENOENT) {
+      girara_warning("Failed to read history file '%s': %s", priv->path, g_strerror(errsv));
+    }
+    if (fd != -1) {
+      g_close(fd, NULL);
+    }
+    *reload = true;
+    *cursor = priv->generation << FILE_IO_OFFSET_BITS;
+    return girara_list_new();
+  }
+
+  if (priv->inode != 0 && (info.st_dev != priv->device || info.st_ino != priv->inode)) {
+    /* another process replaced the file */
+    ++priv->generation;
+  }
+  priv->device = info.st_dev;
+  priv->inode  = info.st_ino;
+
+  if (*cursor >> FILE_IO_OFFSET_BITS != priv->generation) {
+    *reload = true;
+  }
+  size_t offset       = *reload == true ? 0 : *cursor & FILE_IO_OFFSET_MASK;
+  const size_t length = info.st_size;
+  if (offset > length) {
+    /* the file was truncated */
+    *reload = true;
+    offset  = 0;
+  }
+  *cursor      = priv->generation << FILE_IO_OFFSET_BITS | offset;
+  priv->length = length;
+  if (offset == length) {
+    /* nothing was added, which is the common case when checking for changes */
+    g_close(fd, NULL);
+    if (*reload == true) {
+      priv->lines = 0;
+    }
+    return girara_list_new();
+  }
+
+  /* only the pages of the new tail are read */
+  g_autoptr(GError) error     = NULL;
+  g_autoptr(GMappedFile) file = g_mapped_file_new_from_fd(fd, FALSE, &error);
+  g_close(fd, NULL);
+  if (file == NULL) {
+    girara_warning("Failed to read history file '%s': %s", priv->path, error->message);
+    return girara_list_new();
+  }
+
+  /* the file might have changed since it was checked */
+  const size_t mapped = g_mapped_file_get_length(file);
+  if (offset > mapped) {
+    *reload = true;
+    offset  = 0;
+  }
+  priv->length = mapped;
+
+  const char* data    = mapped != 0 ? g_mapped_file_get_contents(file) : "";
+  size_t consumed     = 0;
+  girara_list_t* list = ih_file_split(data + offset, mapped - offset, &consumed);
+  if (*reload == true) {
+    priv->lines = girara_list_size(list);
+  }
+
+  *cursor = priv->generation << FILE_IO_OFFSET_BITS | (offset + consumed);
+  return list;
+}
+
+static girara_list_t* ih_file_io_read(GiraraInputHistoryIO* object) {
+  guint64 cursor = 0;
+  bool reload    = true;
+  return ih_file_io_read_since(object, &cursor, &reload);
+}
+
+static void ih_file_io_evict(GiraraInputHistoryIO* object, const char* input) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(object);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  g_hash_table_add(priv->evicted, g_strdup(input));
+  ih_file_io_maybe_compact(io);
+}
+
+static void ih_file_io_file_changed(GFileMonitor* GIRARA_UNUSED(monitor), GFile* GIRARA_UNUSED(file),
+                                    GFile* GIRARA_UNUSED(other), GFileMonitorEvent event, gpointer data) {
+  switch (event) {
+  case G_FILE_MONITOR_EVENT_CHANGED:
+  case G_FILE_MONITOR_EVENT_CREATED:
+  case G_FILE_MONITOR_EVENT_MOVED_IN:
+  case G_FILE_MONITOR_EVENT_RENAMED:
+    break;
+  default:
+    return;
+  }
+
+  /* events are delivered late, so check whether anything was added since the
+   * file was last read or written by this process */
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(data);
+  struct stat info;
+  if (stat(priv->path, &info) == 0 && ih_file_io_is_same(priv, &info) == true &&
+      (size_t)info.st_size == priv->length) {
+    return;
+  }
+
+  g_signal_emit_by_name(data, "changed");
+}
+
+static void ih_file_io_iface_init(GiraraInputHistoryIOInterface* iface) {
+  iface->append       = ih_file_io_append;
+  iface->read         = ih_file_io_read;
+  iface->read_since   = ih_file_io_read_since;
+  iface->evict        = ih_file_io_evict;
+  iface->append_batch = ih_file_io_append_batch;
+}
+
+/* Compaction */
+
+/**
+ * State of a compaction
+ */
+typedef struct ih_file_compaction_s {
+  char* path;
+  guint max_entries;
+  GHashTable* evicted; /**< Copy of the evicted inputs */
+  dev_t device;        /**< Device of the compacted file */
+  ino_t inode;         /**< Inode of the compacted file */
+  size_t length;       /**< Length of the compacted part of the file */
+  size_t lines;        /**< Number of lines in the rewritten file */
+  char* temporary;     /**< Path of the rewritten file */
+} ih_file_compaction_t;
+
+static void ih_file_compaction_free(void* data) {
+  ih_file_compaction_t* compaction = data;
+  if (compaction->temporary != NULL) {
+    g_unlink(compaction->temporary);
+    g_free(compaction->temporary);
+  }
+  g_hash_table_destroy(compaction->evicted);
+  g_free(compaction->path);
+  g_free(compaction);
+}
+
+/* Write the most recent occurrences of the inputs to a temporary file. */
+static void ih_file_compact_thread(GTask* task, gpointer GIRARA_UNUSED(source), gpointer task_data,
+                                   GCancellable* GIRARA_UNUSED(cancellable)) {
+  ih_file_compaction_t* compaction = task_data;
+  if (g_task_return_error_if_cancelled(task) == TRUE) {
+    return;
+  }
+
+  GError* error = NULL;
+  const int in  = g_open(compaction->path, O_RDONLY | O_CLOEXEC, 0);
+  struct stat info;
+  if (in == -1 || fstat(in, &info) != 0) {
+    const int errsv = errno;
+    if (in != -1) {
+      g_close(in, NULL);
+    }
+    g_task_return_new_error(task, G_FILE_ERROR, g_file_error_from_errno(errsv), "%s", g_strerror(errsv));
+    return;
+  }
+  compaction->device = info.st_dev;
+  compaction->inode  = info.st_ino;
+
+  g_autoptr(GMappedFile) file = g_mapped_file_new_from_fd(in, FALSE, &error);
+  g_close(in, NULL);
+  if (file == NULL) {
+    g_task_return_error(task, error);
+    return;
+  }
+
+  const size_t length             = g_mapped_file_get_length(file);
+  const char* contents            = length != 0 ? g_mapped_file_get_contents(file) : "";
+  g_autoptr(girara_list_t) inputs = ih_file_split(contents, length, &compaction->length);
+  g_autoptr(GHashTable) seen      = g_hash_table_new(g_str_hash, g_str_equal);
+  g_autoptr(GPtrArray) kept       = g_ptr_array_new();
+  for (size_t idx = girara_list_size(inputs); idx != 0; --idx) {
+    char* input = girara_list_nth(inputs, idx - 1);
+    if (compaction->max_entries != 0 && kept->len == compaction->max_entries) {
+      break;
+    }
+    if (g_hash_table_contains(compaction->evicted, input) == FALSE && g_hash_table_add(seen, input) == TRUE) {
+      g_ptr_array_add(kept, input);
+    }
+  }
+
+  g_autoptr(GString) data = g_string_new(NULL);
+  for (size_t idx = kept->len; idx != 0; --idx) {
+    g_string_append(data, g_ptr_array_index(kept, idx - 1));
+    g_string_append_c(data, '\n');
+  }
+  compaction->lines = kept->len;
+
+  /* the file is replaced by renaming, so write next to it */
+  compaction->temporary = g_strdup_printf("%s.XXXXXX", compaction->path);
+  const int fd          = g_mkstemp_full(compaction->temporary, O_WRONLY | O_CLOEXEC, 0600);
+  if (fd == -1) {
+    const int errsv = errno;
+    g_clear_pointer(&compaction->temporary, g_free);
+    g_task_return_new_error(task, G_FILE_ERROR, g_file_error_from_errno(errsv), "%s", g_strerror(errsv));
+    return;
+  }
+
+  bool written = ih_file_write_all(fd, data->str, data->len, &error);
+  if (written == true && fsync(fd) != 0) {
+    ih_file_set_error(&error, errno);
+    written = false;
+  }
+  g_close(fd, NULL);
+  if (written == false) {
+    g_task_return_error(task, error);
+    return;
+  }
+
+  g_task_return_boolean(task, TRUE);
+}
+
+/* Copy what was appended while compacting to the rewritten file and move it
+ * into place. Expects the file to be acquired. */
+static bool ih_file_io_swap(GiraraInputHistoryFileIOPrivate* priv, ih_file_compaction_t* compaction, size_t* tail_lines,
+                            GError** error) {
+  struct stat info;
+  if (fstat(priv->fd, &info) != 0) {
+    ih_file_set_error(error, errno);
+    return false;
+  }
+  if (info.st_dev != compaction->device || info.st_ino != compaction->inode) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "The history file was replaced while compacting");
+    return false;
+  }
+
+  g_autoptr(GMappedFile) file = g_mapped_file_new_from_fd(priv->fd, FALSE, error);
+  if (file == NULL) {
+    return false;
+  }
+
+  const size_t length = g_mapped_file_get_length(file);
+  if (length < compaction->length) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "The history file was truncated while compacting");
+    return false;
+  }
+
+  const char* tail  = length != 0 ? g_mapped_file_get_contents(file) + compaction->length : "";
+  const size_t size = length - compaction->length;
+  if (size != 0) {
+    const int fd = g_open(compaction->temporary, O_WRONLY | O_APPEND | O_CLOEXEC, 0600);
+    if (fd == -1) {
+      ih_file_set_error(error, errno);
+      return false;
+    }
+    const bool written = ih_file_write_all(fd, tail, size, error);
+    g_close(fd, NULL);
+    if (written == false) {
+      return false;
+    }
+  }
+
+  if (g_rename(compaction->temporary, priv->path) != 0) {
+    ih_file_set_error(error, errno);
+    return false;
+  }
+  g_clear_pointer(&compaction->temporary, g_free);
+
+  *tail_lines = ih_file_count_lines(tail, size);
+  return true;
+}
+
+/* Replace the file by the rewritten one. */
+static bool ih_file_io_replace(GiraraInputHistoryFileIO* io, ih_file_compaction_t* compaction, GError** error) {
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+  if (ih_file_io_acquire(priv, error) == false) {
+    return false;
+  }
+
+  size_t tail_lines = 0;
+  if (ih_file_io_swap(priv, compaction, &tail_lines, error) == false) {
+    ih_file_io_release(priv);
+    return false;
+  }
+
+  /* the old file is gone, and so are the cursors into it; other processes
+   * waiting for the lock notice that it was replaced */
+  ih_file_io_close(priv);
+  ++priv->generation;
+  priv->inode = 0;
+  priv->lines = compaction->lines + tail_lines;
+
+  GHashTableIter iter;
+  gpointer input = NULL;
+  g_hash_table_iter_init(&iter, compaction->evicted);
+  while (g_hash_table_iter_next(&iter, &input, NULL) == TRUE) {
+    g_hash_table_remove(priv->evicted, input);
+  }
+
+  return true;
+}
+
+static void ih_file_io_compact_done(GObject* source, GAsyncResult* result, gpointer data) {
+  GiraraInputHistoryFileIO* io          = GIRARA_INPUT_HISTORY_FILE_IO(source);
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+  GTask* task                           = data;
+  priv->compacting                      = false;
+
+  GError* error                    = NULL;
+  ih_file_compaction_t* compaction = g_task_get_task_data(G_TASK(result));
+  if (g_task_propagate_boolean(G_TASK(result), &error) == FALSE ||
+      ih_file_io_replace(io, compaction, &error) == false) {
+    g_task_return_error(task, error);
+  } else {
+    g_task_return_boolean(task, TRUE);
+  }
+  g_object_unref(task);
+}
+
+void girara_input_history_file_io_compact_async(GiraraInputHistoryFileIO* io, GCancellable* cancellable,
+                                                GAsyncReadyCallback callback, gpointer user_data) {
+  g_return_if_fail(GIRARA_IS_INPUT_HISTORY_FILE_IO(io));
+  GiraraInputHistoryFileIOPrivate* priv = girara_input_history_file_io_get_instance_private(io);
+
+  GTask* task = g_task_new(io, cancellable, callback, user_data);
+  if (priv->compacting == true) {
+    g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_PENDING, "The history file is already being compacted");
+    g_object_unref(task);
+    return;
+  }
+  priv->compacting = true;
+
+  ih_file_compaction_t* compaction = g_new0(ih_file_compaction_t, 1);
+  compaction->path                 = g_strdup(priv->path);
+  compaction->max_entries          = priv->max_entries;
+  compaction->evicted              = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+  GHashTableIter iter;
+  gpointer input = NULL;
+  g_hash_table_iter_init(&iter, priv->evicted);
+  while (g_hash_table_iter_next(&iter, &input, NULL) == TRUE) {
+    g_hash_table_add(compaction->evicted, g_strdup(input));
+  }
+
+  g_autoptr(GTask) worker = g_task_new(io, cancellable, ih_file_io_compact_done, task);
+  g_task_set_task_data(worker, compaction, ih_file_compaction_free);
+  g_task_run_in_thread(worker, ih_file_compact_thread);
+}
+
+bool girara_input_history_file_io_compact_finish(GiraraInputHistoryFileIO* io, GAsyncResult* result,
+                                                 GError** error) {
+  g_return_val_if_fail(GIRARA_IS_INPUT_HISTORY_FILE_IO(io), false);
+  g_return_val_if_fail(g_task_is_valid(result, io), false);
+
+  return g_task_propagate_boolean(G_TASK(result), error);
+}
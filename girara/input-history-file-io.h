@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: Zlib */
+
+#ifndef GIRARA_INPUT_HISTORY_FILE_IO_H
+#define GIRARA_INPUT_HISTORY_FILE_IO_H
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "types.h"
+#include "macros.h"
+#include "input-history.h"
+
+struct girara_input_history_file_io_s {
+  GObject parent;
+};
+
+struct girara_input_history_file_io_class_s {
+  GObjectClass parent_class;
+};
+
+#define GIRARA_TYPE_INPUT_HISTORY_FILE_IO (girara_input_history_file_io_get_type())
+#define GIRARA_INPUT_HISTORY_FILE_IO(obj)                                                                              \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj), GIRARA_TYPE_INPUT_HISTORY_FILE_IO, GiraraInputHistoryFileIO))
+#define GIRARA_INPUT_HISTORY_FILE_IO_CLASS(obj)                                                                        \
+  (G_TYPE_CHECK_CLASS_CAST((obj), GIRARA_TYPE_INPUT_HISTORY_FILE_IO, GiraraInputHistoryFileIOClass))
+#define GIRARA_IS_INPUT_HISTORY_FILE_IO(obj) (G_TYPE_CHECK_INSTANCE_TYPE((obj), GIRARA_TYPE_INPUT_HISTORY_FILE_IO))
+#define GIRARA_IS_INPUT_HISTORY_FILE_IO_CLASS(obj) (G_TYPE_CHECK_CLASS_TYPE((obj), GIRARA_TYPE_INPUT_HISTORY_FILE_IO))
+#define GIRARA_INPUT_HISTORY_FILE_IO_GET_CLASS(obj)                                                                    \
+  (G_TYPE_INSTANCE_GET_CLASS((obj), GIRARA_TYPE_INPUT_HISTORY_FILE_IO, GiraraInputHistoryFileIOClass))
+
+/**
+ * Returns the type of the input history file storage.
+ *
+ * @return the type
+ */
+GType girara_input_history_file_io_get_type(void) GIRARA_VISIBLE;
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GiraraInputHistoryFileIO, g_object_unref)
+
+/**
+ * Create a new input history storage backed by a file. The file contains one
+ * input per line and is only appended to. Duplicate inputs, inputs evicted
+ * from the input history and inputs exceeding the max-entries property are
+ * removed by rewriting the file in the background once they make up half of
+ * it. Inputs containing a newline are not written to the file and a warning
+ * is logged for them.
+ *
+ * @param path path of the file
+ * @returns an input history storage object
+ */
+GiraraInputHistoryFileIO* girara_input_history_file_io_new(const char* path) GIRARA_VISIBLE;
+
+/**
+ * Create a new input history storage backed by a file that is shared with
+ * other processes. Writes are serialized with an advisory lock on the file,
+ * and the "changed" signal is emitted whenever another process appended to
+ * the file or rewrote it, so that only the new inputs have to be read.
+ *
+ * @param path path of the file
+ * @returns an input history storage object
+ */
+GiraraInputHistoryFileIO* girara_input_history_file_io_new_shared(const char* path) GIRARA_VISIBLE;
+
+/**
+ * Rewrite the file in the background, keeping only the most recent
+ * occurrence of every input that was not evicted from the input history, and
+ * at most max-entries inputs.
+ *
+ * @param io a GiraraInputHistoryFileIO object
+ * @param cancellable a GCancellable, may be NULL
+ * @param callback callback to call when the file was rewritten, may be NULL
+ * @param user_data data passed to the callback
+ */
+void girara_input_history_file_io_compact_async(GiraraInputHistoryFileIO* io, GCancellable* cancellable,
+                                                GAsyncReadyCallback callback, gpointer user_data) GIRARA_VISIBLE;
+
+/**
+ * Finish rewriting the file started with @ref
+ * girara_input_history_file_io_compact_async.
+ *
+ * @param io a GiraraInputHistoryFileIO object
+ * @param result the GAsyncResult passed to the callback
+ * @param error return location for an error
+ * @returns true if the file was rewritten
+ */
+bool girara_input_history_file_io_compact_finish(GiraraInputHistoryFileIO* io, GAsyncResult* result,
+                                                 GError** error) GIRARA_VISIBLE;
+
+#endif
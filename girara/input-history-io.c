@@ -2,9 +2,17 @@
 
 #include "input-history.h"
 
+#include "datastructures.h"
+
 G_DEFINE_INTERFACE(GiraraInputHistoryIO, girara_input_history_io, G_TYPE_OBJECT)
 
-static void girara_input_history_io_default_init(GiraraInputHistoryIOInterface* GIRARA_UNUSED(iface)) {}
+static void girara_input_history_io_default_init(GiraraInputHistoryIOInterface* iface) {
+  /**
+   * Emitted when inputs were added to the storage by someone else, e.g. by
+   * another process.
+   */
+  g_signal_new("changed", G_TYPE_FROM_INTERFACE(iface), G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
+}
 
 void girara_input_history_io_append(GiraraInputHistoryIO* io, const char* input) {
   g_return_if_fail(io != NULL);
@@ -15,3 +23,206 @@ girara_list_t* girara_input_history_io_read(GiraraInputHistoryIO* io) {
   g_return_val_if_fail(io != NULL, NULL);
   return GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io)->read(io);
 }
+
+girara_list_t* girara_input_history_io_read_since(GiraraInputHistoryIO* io, guint64* cursor, bool* reload) {
+  g_return_val_if_fail(io != NULL && cursor != NULL && reload != NULL, NULL);
+
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  if (iface->read_since == NULL) {
+    /* there is no way to tell what changed */
+    *reload = true;
+    return iface->read(io);
+  }
+
+  *reload = *cursor == 0;
+  return iface->read_since(io, cursor, reload);
+}
+
+void girara_input_history_io_evict(GiraraInputHistoryIO* io, const char* input) {
+  g_return_if_fail(io != NULL);
+
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  if (iface->evict != NULL) {
+    iface->evict(io, input);
+  }
+}
+
+void girara_input_history_io_append_async(GiraraInputHistoryIO* io, const char* input, GCancellable* cancellable,
+                                          GAsyncReadyCallback callback, gpointer user_data) {
+  g_return_if_fail(io != NULL);
+
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  g_return_if_fail((iface->append_async == NULL) == (iface->append_finish == NULL));
+  if (iface->append_async != NULL) {
+    iface->append_async(io, input, cancellable, callback, user_data);
+    return;
+  }
+
+  /* fall back to the synchronous method */
+  g_autoptr(GTask) task = g_task_new(io, cancellable, callback, user_data);
+  iface->append(io, input);
+  g_task_return_boolean(task, TRUE);
+}
+
+bool girara_input_history_io_append_finish(GiraraInputHistoryIO* io, GAsyncResult* result, GError** error) {
+  g_return_val_if_fail(io != NULL && result != NULL, false);
+
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  g_return_val_if_fail((iface->append_async == NULL) == (iface->append_finish == NULL), false);
+  if (iface->append_finish == NULL) {
+    return g_task_propagate_boolean(G_TASK(result), error);
+  }
+
+  return iface->append_finish(io, result, error);
+}
+
+/**
+ * Result of a synchronous read
+ */
+typedef struct ih_io_read_s {
+  guint64 cursor; /**< Position after the read items */
+  bool reload;    /**< All items were read */
+} ih_io_read_t;
+
+void girara_input_history_io_read_async(GiraraInputHistoryIO* io, guint64 cursor, GCancellable* cancellable,
+                                        GAsyncReadyCallback callback, gpointer user_data) {
+  g_return_if_fail(io != NULL);
+
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  g_return_if_fail((iface->read_async == NULL) == (iface->read_finish == NULL));
+  if (iface->read_async != NULL) {
+    iface->read_async(io, cursor, cancellable, callback, user_data);
+    return;
+  }
+
+  /* fall back to the synchronous method */
+  g_autoptr(GTask) task = g_task_new(io, cancellable, callback, user_data);
+  ih_io_read_t* read    = g_new0(ih_io_read_t, 1);
+  read->cursor          = cursor;
+  g_task_set_task_data(task, read, g_free);
+
+  girara_list_t* inputs = girara_input_history_io_read_since(io, &read->cursor, &read->reload);
+  g_task_return_pointer(task, inputs, (GDestroyNotify)girara_list_free);
+}
+
+girara_list_t* girara_input_history_io_read_finish(GiraraInputHistoryIO* io, GAsyncResult* result, guint64* cursor,
+                                                   bool* reload, GError** error) {
+  g_return_val_if_fail(io != NULL && result != NULL && cursor != NULL && reload != NULL, NULL);
+
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  g_return_val_if_fail((iface->read_async == NULL) == (iface->read_finish == NULL), NULL);
+  if (iface->read_finish == NULL) {
+    const ih_io_read_t* read = g_task_get_task_data(G_TASK(result));
+    *cursor                  = read->cursor;
+    *reload                  = read->reload;
+    return g_task_propagate_pointer(G_TASK(result), error);
+  }
+
+  *reload = false;
+  return iface->read_finish(io, result, cursor, reload, error);
+}
+
+void girara_input_history_io_append_batch(GiraraInputHistoryIO* io, girara_list_t* inputs, guint64* cursor) {
+  g_return_if_fail(io != NULL && inputs != NULL);
+
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  if (iface->append_batch != NULL) {
+    iface->append_batch(io, inputs, cursor);
+    return;
+  }
+
+  /* there is no way to tell whether the inputs were appended right at the
+   * cursor, so they are read again */
+  for (size_t idx = 0; idx != girara_list_size(inputs); ++idx) {
+    iface->append(io, girara_list_nth(inputs, idx));
+  }
+}
+
+/**
+ * Asynchronous write of a batch, one input at a time
+ */
+typedef struct ih_io_batch_s {
+  girara_list_t* inputs; /**< Inputs to write */
+  size_t written;        /**< Number of inputs written so far */
+  guint64 cursor;        /**< Position after the read items */
+} ih_io_batch_t;
+
+static void ih_io_batch_next(GTask* task);
+
+static void ih_io_batch_done(GObject* source, GAsyncResult* result, gpointer data) {
+  GTask* task = data;
+
+  GError* error = NULL;
+  if (girara_input_history_io_append_finish(GIRARA_INPUT_HISTORY_IO(source), result, &error) == false) {
+    if (error == NULL) {
+      error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to write input");
+    }
+    g_task_return_error(task, error);
+    g_object_unref(task);
+    return;
+  }
+
+  ih_io_batch_t* batch = g_task_get_task_data(task);
+  ++batch->written;
+  ih_io_batch_next(task);
+}
+
+/* Write the next input of the batch. The task is kept alive until all of them
+ * are written. */
+static void ih_io_batch_next(GTask* task) {
+  ih_io_batch_t* batch = g_task_get_task_data(task);
+  if (batch->written == girara_list_size(batch->inputs)) {
+    g_task_return_boolean(task, TRUE);
+    g_object_unref(task);
+    return;
+  }
+
+  girara_input_history_io_append_async(g_task_get_source_object(task), girara_list_nth(batch->inputs, batch->written),
+                                       g_task_get_cancellable(task), ih_io_batch_done, task);
+}
+
+void girara_input_history_io_append_batch_async(GiraraInputHistoryIO* io, girara_list_t* inputs, guint64 cursor,
+                                                GCancellable* cancellable, GAsyncReadyCallback callback,
+                                                gpointer user_data) {
+  g_return_if_fail(io != NULL && inputs != NULL);
+
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  g_return_if_fail((iface->append_batch_async == NULL) == (iface->append_batch_finish == NULL));
+  if (iface->append_batch_async != NULL) {
+    iface->append_batch_async(io, inputs, cursor, cancellable, callback, user_data);
+    return;
+  }
+
+  GTask* task          = g_task_new(io, cancellable, callback, user_data);
+  ih_io_batch_t* batch = g_new0(ih_io_batch_t, 1);
+  batch->inputs        = inputs;
+  batch->cursor        = cursor;
+  g_task_set_task_data(task, batch, g_free);
+
+  if (iface->append_async != NULL) {
+    /* write one input after the other; like with append_batch, there is no
+     * way to tell whether they were appended right at the cursor */
+    ih_io_batch_next(task);
+    return;
+  }
+
+  /* fall back to the synchronous method */
+  girara_input_history_io_append_batch(io, inputs, &batch->cursor);
+  g_task_return_boolean(task, TRUE);
+  g_object_unref(task);
+}
+
+bool girara_input_history_io_append_batch_finish(GiraraInputHistoryIO* io, GAsyncResult* result, guint64* cursor,
+                                                 GError** error) {
+  g_return_val_if_fail(io != NULL && result != NULL && cursor != NULL, false);
+
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  g_return_val_if_fail((iface->append_batch_async == NULL) == (iface->append_batch_finish == NULL), false);
+  if (iface->append_batch_finish == NULL) {
+    const ih_io_batch_t* batch = g_task_get_task_data(G_TASK(result));
+    *cursor                    = batch->cursor;
+    return g_task_propagate_boolean(G_TASK(result), error);
+  }
+
+  return iface->append_batch_finish(io, result, cursor, error);
+}
@@ -0,0 +1,239 @@
+/* SPDX-License-Identifier: Zlib */
+
+#include "internal.h"
+
+#include <string.h>
+
+/* Scores and bonuses as used by fzf */
+#define SCORE_MATCH 16
+#define SCORE_GAP_START -3
+#define SCORE_GAP_EXTENSION -1
+#define BONUS_BOUNDARY (SCORE_MATCH / 2)
+#define BONUS_BOUNDARY_WHITE (BONUS_BOUNDARY + 2)
+#define BONUS_BOUNDARY_DELIMITER (BONUS_BOUNDARY + 1)
+#define BONUS_NON_WORD (SCORE_MATCH / 2)
+#define BONUS_CAMEL_123 (BONUS_BOUNDARY + SCORE_GAP_EXTENSION)
+#define BONUS_CONSECUTIVE (-(SCORE_GAP_START + SCORE_GAP_EXTENSION))
+#define BONUS_FIRST_CHAR_MULTIPLIER 2
+
+typedef enum fuzzy_char_class_e {
+  CHAR_WHITE,
+  CHAR_NON_WORD,
+  CHAR_DELIMITER,
+  CHAR_LOWER,
+  CHAR_UPPER,
+  CHAR_NUMBER,
+} fuzzy_char_class_t;
+
+static unsigned char fuzzy_fold(unsigned char c) {
+  return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+static fuzzy_char_class_t fuzzy_classify(unsigned char c) {
+  if (c >= 'a' && c <= 'z') {
+    return CHAR_LOWER;
+  }
+  if (c >= 'A' && c <= 'Z') {
+    return CHAR_UPPER;
+  }
+  if (c >= '0' && c <= '9') {
+    return CHAR_NUMBER;
+  }
+  if (c >= 0x80) {
+    /* bytes of multi-byte characters count as letters */
+    return CHAR_LOWER;
+  }
+  if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f') {
+    return CHAR_WHITE;
+  }
+  if (c == '/' || c == ',' || c == ':' || c == ';' || c == '|') {
+    return CHAR_DELIMITER;
+  }
+  return CHAR_NON_WORD;
+}
+
+/* Classes of all bytes, looked up while scoring */
+static unsigned char fuzzy_classes[256];
+
+static void fuzzy_init_classes(void) {
+  static gsize initialized = 0;
+  if (g_once_init_enter(&initialized)) {
+    for (unsigned int c = 0; c != G_N_ELEMENTS(fuzzy_classes); ++c) {
+      fuzzy_classes[c] = fuzzy_classify(c);
+    }
+    g_once_init_leave(&initialized, 1);
+  }
+}
+
+static fuzzy_char_class_t fuzzy_char_class(unsigned char c) {
+  return fuzzy_classes[c];
+}
+
+/* Bonus for matching a character of class current that follows one of class
+ * previous; matches at word boundaries score higher. */
+static int fuzzy_bonus(fuzzy_char_class_t previous, fuzzy_char_class_t current) {
+  if (current >= CHAR_LOWER) {
+    if (previous == CHAR_WHITE) {
+      return BONUS_BOUNDARY_WHITE;
+    }
+    if (previous == CHAR_DELIMITER) {
+      return BONUS_BOUNDARY_DELIMITER;
+    }
+    if (previous == CHAR_NON_WORD) {
+      return BONUS_BOUNDARY;
+    }
+  }
+
+  if ((previous == CHAR_LOWER && current == CHAR_UPPER) || (previous != CHAR_NUMBER && current == CHAR_NUMBER)) {
+    return BONUS_CAMEL_123;
+  }
+  if (current == CHAR_NON_WORD || current == CHAR_DELIMITER) {
+    return BONUS_NON_WORD;
+  }
+  if (current == CHAR_WHITE) {
+    return BONUS_BOUNDARY_WHITE;
+  }
+  return 0;
+}
+
+/* Letters ignoring case and digits get a bit each, all other ASCII characters
+ * share the remaining bits but one, which stands for all other bytes. */
+static guint64 fuzzy_bit(unsigned char c) {
+  if (c >= 'a' && c <= 'z') {
+    return G_GUINT64_CONSTANT(1) << (c - 'a');
+  }
+  if (c >= 'A' && c <= 'Z') {
+    return G_GUINT64_CONSTANT(1) << (c - 'A');
+  }
+  if (c >= '0' && c <= '9') {
+    return G_GUINT64_CONSTANT(1) << (26 + c - '0');
+  }
+  if (c >= 0x80) {
+    return G_GUINT64_CONSTANT(1) << 63;
+  }
+  return G_GUINT64_CONSTANT(1) << (36 + c % 27);
+}
+
+guint64 fuzzy_mask(const char* text) {
+  guint64 mask = 0;
+  for (const unsigned char* c = (const unsigned char*)text; *c != '\0'; ++c) {
+    mask |= fuzzy_bit(*c);
+  }
+
+  return mask;
+}
+
+void fuzzy_pattern_init(fuzzy_pattern_t* pattern, const char* query) {
+  /* smart case: only queries containing upper case letters are case sensitive */
+  pattern->case_sensitive = false;
+  for (const char* c = query; *c != '\0'; ++c) {
+    if (*c >= 'A' && *c <= 'Z') {
+      pattern->case_sensitive = true;
+      break;
+    }
+  }
+
+  pattern->text   = pattern->case_sensitive == true ? g_strdup(query) : g_ascii_strdown(query, -1);
+  pattern->length = strlen(query);
+  pattern->mask   = fuzzy_mask(query);
+  for (unsigned int c = 0; c != G_N_ELEMENTS(pattern->fold); ++c) {
+    pattern->fold[c] = pattern->case_sensitive == true ? c : fuzzy_fold(c);
+  }
+  fuzzy_init_classes();
+
+  /* the query as a word of its own: no gaps, the first character after white
+   * space, and the others keeping its bonus */
+  pattern->max_score = 0;
+  if (pattern->length != 0) {
+    const fuzzy_char_class_t first = fuzzy_char_class(pattern->text[0]);
+    const int bonus                = first >= CHAR_LOWER || first == CHAR_WHITE ? BONUS_BOUNDARY_WHITE : BONUS_NON_WORD;
+    pattern->max_score             = SCORE_MATCH + bonus * BONUS_FIRST_CHAR_MULTIPLIER +
+                                     (int)(pattern->length - 1) * (SCORE_MATCH + BONUS_BOUNDARY_WHITE);
+  }
+}
+
+void fuzzy_pattern_clear(fuzzy_pattern_t* pattern) {
+  g_clear_pointer(&pattern->text, g_free);
+}
+
+static int fuzzy_score(const fuzzy_pattern_t* pattern, const unsigned char* text, size_t start, size_t end) {
+  const unsigned char* query  = (const unsigned char*)pattern->text;
+  fuzzy_char_class_t previous = start != 0 ? fuzzy_char_class(text[start - 1]) : CHAR_WHITE;
+  size_t pidx                 = 0;
+  int score                   = 0;
+  int first_bonus             = 0;
+  size_t consecutive          = 0;
+  bool in_gap                 = false;
+
+  for (size_t idx = start; idx != end; ++idx) {
+    const unsigned char c            = pattern->fold[text[idx]];
+    const fuzzy_char_class_t current = fuzzy_char_class(text[idx]);
+    if (pidx != pattern->length && c == query[pidx]) {
+      int bonus = fuzzy_bonus(previous, current);
+      if (consecutive == 0) {
+        first_bonus = bonus;
+      } else {
+        /* a consecutive chunk keeps the bonus of its first character */
+        if (bonus >= BONUS_BOUNDARY && bonus > first_bonus) {
+          first_bonus = bonus;
+        }
+        bonus = MAX(MAX(bonus, first_bonus), BONUS_CONSECUTIVE);
+      }
+
+      score += SCORE_MATCH + (pidx == 0 ? bonus * BONUS_FIRST_CHAR_MULTIPLIER : bonus);
+      in_gap = false;
+      ++consecutive;
+      ++pidx;
+    } else {
+      score += in_gap == true ? SCORE_GAP_EXTENSION : SCORE_GAP_START;
+      in_gap      = true;
+      consecutive = 0;
+      first_bonus = 0;
+    }
+    previous = current;
+  }
+
+  return score;
+}
+
+bool fuzzy_match(const fuzzy_pattern_t* pattern, const char* input, int* score) {
+  const unsigned char* text  = (const unsigned char*)input;
+  const unsigned char* query = (const unsigned char*)pattern->text;
+  if (pattern->length == 0) {
+    *score = 0;
+    return true;
+  }
+
+  /* find the first occurrence of the pattern as subsequence ... */
+  size_t pidx  = 0;
+  size_t start = 0;
+  size_t end   = 0;
+  for (size_t idx = 0; text[idx] != '\0'; ++idx) {
+    const unsigned char c = pattern->fold[text[idx]];
+    if (c == query[pidx]) {
+      if (pidx == 0) {
+        start = idx;
+      }
+      if (++pidx == pattern->length) {
+        end = idx + 1;
+        break;
+      }
+    }
+  }
+  if (pidx != pattern->length) {
+    return false;
+  }
+
+  /* ... and the shortest one ending at the same character */
+  pidx = pattern->length;
+  for (size_t idx = end; idx-- > start;) {
+    const unsigned char c = pattern->fold[text[idx]];
+    if (c == query[pidx - 1] && --pidx == 0) {
+      start = idx;
+      break;
+    }
+  }
+
+  *score = fuzzy_score(pattern, text, start, end);
+  return true;
+}
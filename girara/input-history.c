@@ -2,17 +2,59 @@
 
 #include "input-history.h"
 
+#include <string.h>
+
 #include "datastructures.h"
 #include "internal.h"
+#include "log.h"
+
+/* Number of inputs worth searching on a separate thread */
+#define IH_SEARCH_MIN_PER_THREAD 65536
+/* Nodes of the prefix index are far more expensive to visit than inputs are to
+ * scan, so searching it is given up after visiting one node per this many
+ * inputs, but no less than IH_SEARCH_MIN_NODES */
+#define IH_SEARCH_INPUTS_PER_NODE 32
+#define IH_SEARCH_MIN_NODES 4096
+
+/**
+ * Batch of inputs waiting to be written to io
+ */
+typedef struct ih_write_s {
+  GiraraInputHistoryIO* io; /**< Storage the inputs are written to */
+  girara_list_t* inputs;    /**< Inputs, oldest first */
+  guint64 cursor;           /**< Read cursor when the write started */
+} ih_write_t;
 
 /**
  * Private data of the input history
  */
 typedef struct ih_private_s {
-  girara_list_t* history; /**< List of stored inputs */
-  size_t current;
-  size_t current_match;
+  char** entries;         /**< Ring buffer of stored inputs, NULL for inputs that were moved to the end */
+  guint64* masks;         /**< Characters contained in the entries, see fuzzy_mask */
+  size_t capacity;        /**< Size of the ring buffer */
+  size_t head;            /**< Slot of the oldest entry */
+  size_t n_entries;       /**< Number of entries */
+  size_t n_moved;         /**< Number of NULL entries */
+  size_t first;           /**< Position of the oldest entry */
+  guint max_entries;      /**< Maximal number of stored inputs, 0 for no limit */
+  GHashTable* index;      /**< Maps stored inputs to their position */
+  girara_trie_t* inputs;  /**< Prefix index of the stored inputs, ranked by position */
+  girara_list_t* history; /**< List of stored inputs, built from entries */
+  bool history_valid;     /**< The list matches the entries */
+  bool match_all;         /**< All inputs match the command-line */
+  size_t current_match;   /**< Position of the current match, its index if the list is overridden */
+  size_t current;         /**< Index of the current item if the list is overridden */
+  guint64 revision;       /**< Changes whenever inputs are stored, moved or removed */
   GiraraInputHistoryIO* io;
+  guint64 cursor;           /**< Position after the inputs read from io */
+  GQueue appends;           /**< Batches waiting to be written to io, the first one is being written */
+  bool reading;             /**< Inputs are being read from io */
+  bool read_again;          /**< Read from io again once the current read is done */
+  girara_list_t* unwritten; /**< Inputs collected to be written to io in a batch */
+  guint flush_threshold;    /**< Number of collected inputs that triggers a write, 0 to write every input */
+  guint flush_interval;     /**< Milliseconds after which collected inputs are written, 0 to wait until idle */
+  guint flush_idle;         /**< Source writing the collected inputs when idle */
+  guint flush_timeout;      /**< Source writing the collected inputs after flush_interval */
   char* command_line;
   bool reset; /**< Show history starting from the most recent command */
 } GiraraInputHistoryPrivate;
@@ -29,11 +71,20 @@ static girara_list_t* ih_list(GiraraInputHistory* history);
 static const char* ih_next(GiraraInputHistory* history, const char* current_input);
 static const char* ih_previous(GiraraInputHistory* history, const char* current_input);
 static void ih_reset(GiraraInputHistory* history);
+static void ih_flush(GiraraInputHistory* history);
+static girara_list_t* ih_search(GiraraInputHistory* history, const char* query, size_t max_results,
+                                unsigned int n_threads);
+static void ih_io_changed(GiraraInputHistoryIO* io, GiraraInputHistory* history);
+static void ih_evict(GiraraInputHistoryPrivate* priv);
+static void ih_write_free(ih_write_t* write);
 
 /* Properties */
 enum {
   PROP_0,
   PROP_IO,
+  PROP_MAX_ENTRIES,
+  PROP_FLUSH_THRESHOLD,
+  PROP_FLUSH_INTERVAL,
 };
 
 /* Class init */
@@ -50,6 +101,8 @@ static void girara_input_history_class_init(GiraraInputHistoryClass* class) {
   class->next     = ih_next;
   class->previous = ih_previous;
   class->reset    = ih_reset;
+  class->flush    = ih_flush;
+  class->search   = ih_search;
 
   /* properties */
   g_object_class_install_property(
@@ -57,12 +110,32 @@ static void girara_input_history_class_init(GiraraInputHistoryClass* class) {
       g_param_spec_object("io", "history reader/writer", "GiraraInputHistoryIO object used to read and write history",
                           girara_input_history_io_get_type(),
                           G_PARAM_WRITABLE | G_PARAM_READABLE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property(
+      object_class, PROP_MAX_ENTRIES,
+      g_param_spec_uint("max-entries", "maximal number of entries",
+                        "Maximal number of stored inputs, the oldest inputs are evicted first; 0 for no limit", 0,
+                        G_MAXUINT, 0, G_PARAM_WRITABLE | G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property(
+      object_class, PROP_FLUSH_THRESHOLD,
+      g_param_spec_uint("flush-threshold", "flush threshold",
+                        "Number of collected inputs that are written to io at once; 0 to write every input", 0,
+                        G_MAXUINT, 0, G_PARAM_WRITABLE | G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property(
+      object_class, PROP_FLUSH_INTERVAL,
+      g_param_spec_uint("flush-interval", "flush interval",
+                        "Milliseconds after which collected inputs are written to io; 0 to wait until idle", 0,
+                        G_MAXUINT, 1000, G_PARAM_WRITABLE | G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 }
 
 /* Object init */
 static void girara_input_history_init(GiraraInputHistory* history) {
   GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
-  priv->history                   = girara_list_new_with_free(g_free);
+  priv->index                     = g_hash_table_new(g_str_hash, g_str_equal);
+  priv->inputs                    = girara_trie_new();
+  priv->history                   = girara_list_new();
+  priv->unwritten                 = girara_list_new_with_free(g_free);
+  priv->flush_interval            = 1000;
+  priv->history_valid             = true;
   priv->reset                     = true;
   priv->io                        = NULL;
 }
@@ -72,6 +145,11 @@ static void ih_dispose(GObject* object) {
   GiraraInputHistory* ih          = GIRARA_INPUT_HISTORY(object);
   GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(ih);
 
+  /* do not lose any collected inputs */
+  ih_flush(ih);
+  if (priv->io != NULL) {
+    g_signal_handlers_disconnect_by_data(priv->io, ih);
+  }
   g_clear_object(&priv->io);
 
   G_OBJECT_CLASS(girara_input_history_parent_class)->dispose(object);
@@ -82,7 +160,16 @@ static void ih_finalize(GObject* object) {
   GiraraInputHistory* ih          = GIRARA_INPUT_HISTORY(object);
   GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(ih);
   girara_list_free(priv->history);
+  girara_list_free(priv->unwritten);
+  girara_trie_free(priv->inputs);
+  g_hash_table_destroy(priv->index);
+  for (size_t idx = 0; idx != priv->n_entries; ++idx) {
+    g_free(priv->entries[(priv->head + idx) % priv->capacity]);
+  }
+  g_free(priv->entries);
+  g_free(priv->masks);
   g_free(priv->command_line);
+  g_queue_clear_full(&priv->appends, (GDestroyNotify)ih_write_free);
 
   G_OBJECT_CLASS(girara_input_history_parent_class)->finalize(object);
 }
@@ -94,15 +181,35 @@ static void ih_set_property(GObject* object, guint prop_id, const GValue* value,
 
   switch (prop_id) {
   case PROP_IO: {
+    ih_flush(ih);
+    if (priv->io != NULL) {
+      g_signal_handlers_disconnect_by_data(priv->io, ih);
+    }
     g_clear_object(&priv->io);
 
     gpointer* tmp = g_value_dup_object(value);
     if (tmp != NULL) {
       priv->io = GIRARA_INPUT_HISTORY_IO(tmp);
+      g_signal_connect(priv->io, "changed", G_CALLBACK(ih_io_changed), ih);
     }
+    priv->cursor = 0;
     girara_input_history_reset(GIRARA_INPUT_HISTORY(object));
     break;
   }
+  case PROP_MAX_ENTRIES:
+    priv->max_entries = g_value_get_uint(value);
+    priv->reset       = true;
+    ih_evict(priv);
+    break;
+  case PROP_FLUSH_THRESHOLD:
+    priv->flush_threshold = g_value_get_uint(value);
+    if (priv->flush_threshold == 0 || girara_list_size(priv->unwritten) >= priv->flush_threshold) {
+      ih_flush(ih);
+    }
+    break;
+  case PROP_FLUSH_INTERVAL:
+    priv->flush_interval = g_value_get_uint(value);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
   }
@@ -117,6 +224,15 @@ static void ih_get_property(GObject* object, guint prop_id, GValue* value, GPara
   case PROP_IO:
     g_value_set_object(value, priv->io);
     break;
+  case PROP_MAX_ENTRIES:
+    g_value_set_uint(value, priv->max_entries);
+    break;
+  case PROP_FLUSH_THRESHOLD:
+    g_value_set_uint(value, priv->flush_threshold);
+    break;
+  case PROP_FLUSH_INTERVAL:
+    g_value_set_uint(value, priv->flush_interval);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
   }
@@ -129,38 +245,339 @@ GiraraInputHistory* girara_input_history_new(GiraraInputHistoryIO* io) {
 
 /* Method implementions */
 
-static void ih_append(GiraraInputHistory* history, const char* input) {
-  if (input == NULL) {
+/* Position after the newest entry. */
+static size_t ih_end(GiraraInputHistoryPrivate* priv) {
+  return priv->first + priv->n_entries;
+}
+
+/* Slot of the entry at a position. Positions keep increasing as entries are
+ * added, so evicting the oldest entry does not move the remaining ones. */
+static size_t ih_slot(GiraraInputHistoryPrivate* priv, size_t position) {
+  const size_t slot = priv->head + position - priv->first;
+  return slot < priv->capacity ? slot : slot - priv->capacity;
+}
+
+static char** ih_entry(GiraraInputHistoryPrivate* priv, size_t position) {
+  return &priv->entries[ih_slot(priv, position)];
+}
+
+/* Empty the list of stored inputs so that it does not point to inputs that
+ * are moved or freed, and rebuild it when it is requested again. */
+static void ih_invalidate_list(GiraraInputHistoryPrivate* priv) {
+  girara_list_reset(priv->history);
+  priv->history_valid = false;
+}
+
+static size_t ih_rank(void* input, void* data) {
+  GiraraInputHistoryPrivate* priv = data;
+  return GPOINTER_TO_SIZE(g_hash_table_lookup(priv->index, input));
+}
+
+/* Drop the entries of moved inputs once they make up half of the entries.
+ * The current match moves along with its entry. */
+static void ih_compact(GiraraInputHistoryPrivate* priv) {
+  if (priv->n_moved <= priv->n_entries / 2) {
     return;
   }
 
-  girara_list_t* list = girara_input_history_list(history);
-  if (list == NULL) {
+  const bool at_end = priv->current_match == ih_end(priv);
+  size_t size       = 0;
+  for (size_t position = priv->first; position != ih_end(priv); ++position) {
+    const size_t slot = ih_slot(priv, position);
+    char* input       = priv->entries[slot];
+    if (input != NULL) {
+      const size_t target   = ih_slot(priv, priv->first + size);
+      priv->entries[target] = input;
+      priv->masks[target]   = priv->masks[slot];
+      g_hash_table_insert(priv->index, input, GSIZE_TO_POINTER(priv->first + size));
+      if (position == priv->current_match) {
+        priv->current_match = priv->first + size;
+      }
+      ++size;
+    }
+  }
+
+  priv->n_entries = size;
+  priv->n_moved   = 0;
+  trie_set_ranks(priv->inputs, ih_rank, priv);
+  if (at_end == true) {
+    priv->current_match = ih_end(priv);
+  }
+}
+
+/* Double the size of a full ring buffer. */
+static void ih_grow(GiraraInputHistoryPrivate* priv) {
+  if (priv->n_entries != priv->capacity) {
     return;
   }
 
-  void* data = NULL;
-  while ((data = girara_list_find(list, list_strcmp, input)) != NULL) {
-    girara_list_remove(list, data);
+  const size_t capacity = MAX(priv->capacity * 2, 16);
+  char** entries        = g_new(char*, capacity);
+  guint64* masks        = g_new(guint64, capacity);
+  for (size_t idx = 0; idx != priv->n_entries; ++idx) {
+    entries[idx] = priv->entries[(priv->head + idx) % priv->capacity];
+    masks[idx]   = priv->masks[(priv->head + idx) % priv->capacity];
   }
 
-  girara_list_append(list, g_strdup(input));
+  g_free(priv->entries);
+  g_free(priv->masks);
+  priv->entries  = entries;
+  priv->masks    = masks;
+  priv->capacity = capacity;
+  priv->head     = 0;
+}
+
+/* Remove the oldest inputs until no more than max_entries are left. */
+static void ih_evict(GiraraInputHistoryPrivate* priv) {
+  while (priv->max_entries != 0 && g_hash_table_size(priv->index) > priv->max_entries) {
+    char* input = priv->entries[priv->head];
+    priv->head  = (priv->head + 1) % priv->capacity;
+    ++priv->first;
+    --priv->n_entries;
+    if (input == NULL) {
+      --priv->n_moved;
+      continue;
+    }
+
+    g_hash_table_remove(priv->index, input);
+    girara_trie_remove(priv->inputs, input);
+    ++priv->revision;
+    if (priv->io != NULL) {
+      girara_input_history_io_evict(priv->io, input);
+    }
+    ih_invalidate_list(priv);
+    g_free(input);
+  }
 
+  if (priv->current_match < priv->first) {
+    /* the current match is gone */
+    priv->reset = true;
+  }
+}
+
+/* Store an input at the end. An input that is already stored is moved there.
+ * If the current match is the command-line after the newest entry, it stays
+ * there. */
+static void ih_store(GiraraInputHistoryPrivate* priv, const char* input) {
+  const bool at_end = priv->current_match == ih_end(priv);
+  char* stored      = NULL;
+  gpointer position = NULL;
+  if (g_hash_table_lookup_extended(priv->index, input, (gpointer*)&stored, &position) == TRUE) {
+    if (GPOINTER_TO_SIZE(position) + 1 == ih_end(priv)) {
+      return;
+    }
+
+    *ih_entry(priv, GPOINTER_TO_SIZE(position)) = NULL;
+    ++priv->n_moved;
+    ih_invalidate_list(priv);
+    if (GPOINTER_TO_SIZE(position) == priv->current_match) {
+      /* the current match is gone */
+      priv->reset = true;
+    }
+    trie_set_rank(priv->inputs, stored, ih_end(priv));
+  } else {
+    stored = g_strdup(input);
+    trie_insert_ranked(priv->inputs, stored, stored, ih_end(priv));
+  }
+  ++priv->revision;
+
+  ih_grow(priv);
+  g_hash_table_insert(priv->index, stored, GSIZE_TO_POINTER(ih_end(priv)));
+  ++priv->n_entries;
+  const size_t slot   = ih_slot(priv, ih_end(priv) - 1);
+  priv->entries[slot] = stored;
+  priv->masks[slot]   = fuzzy_mask(stored);
+  if (priv->history_valid == true) {
+    girara_list_append(priv->history, stored);
+  }
+  if (at_end == true) {
+    priv->current_match = ih_end(priv);
+  }
+
+  ih_compact(priv);
+  ih_evict(priv);
+}
+
+static void ih_clear(GiraraInputHistoryPrivate* priv) {
+  girara_trie_free(priv->inputs);
+  priv->inputs = girara_trie_new();
+  g_hash_table_remove_all(priv->index);
+  for (size_t position = priv->first; position != ih_end(priv); ++position) {
+    g_free(*ih_entry(priv, position));
+  }
+  priv->head      = 0;
+  priv->n_entries = 0;
+  priv->n_moved   = 0;
+  ih_invalidate_list(priv);
+  ++priv->revision;
+}
+
+static bool ih_io_is_async(GiraraInputHistoryIO* io) {
+  GiraraInputHistoryIOInterface* iface = GIRARA_INPUT_HISTORY_IO_GET_INTERFACE(io);
+  return iface->append_async != NULL || iface->append_batch_async != NULL || iface->read_async != NULL;
+}
+
+static void ih_write_free(ih_write_t* write) {
+  g_object_unref(write->io);
+  girara_list_free(write->inputs);
+  g_free(write);
+}
+
+static void ih_write_next(GiraraInputHistory* history);
+
+static void ih_write_done(GObject* source, GAsyncResult* result, gpointer data) {
+  GiraraInputHistory* history     = data;
   GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  ih_write_t* write               = g_queue_pop_head(&priv->appends);
+
+  guint64 cursor          = write->cursor;
+  g_autoptr(GError) error = NULL;
+  if (girara_input_history_io_append_batch_finish(GIRARA_INPUT_HISTORY_IO(source), result, &cursor, &error) == false) {
+    girara_warning("Failed to write input history: %s", error != NULL ? error->message : "unknown error");
+  } else if (write->io == priv->io && write->cursor == priv->cursor) {
+    /* nothing was read in the meantime */
+    priv->cursor = cursor;
+  }
+
+  ih_write_free(write);
+  ih_write_next(history);
+  g_object_unref(history);
+}
+
+/* Write the first waiting batch. The history is kept alive until it is
+ * written. */
+static void ih_write_next(GiraraInputHistory* history) {
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+
+  ih_write_t* write = g_queue_peek_head(&priv->appends);
+  if (write != NULL) {
+    write->cursor = priv->cursor;
+    girara_input_history_io_append_batch_async(write->io, write->inputs, write->cursor, NULL, ih_write_done,
+                                               g_object_ref(history));
+  }
+}
+
+/* Write a batch of inputs and take ownership of the list. Batches that are
+ * written asynchronously go to the io that was set when they were written,
+ * even if the io property was changed or cleared in the meantime. */
+static void ih_write_batch(GiraraInputHistory* history, girara_list_t* inputs) {
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  if (ih_io_is_async(priv->io) == false) {
+    girara_input_history_io_append_batch(priv->io, inputs, &priv->cursor);
+    girara_list_free(inputs);
+    return;
+  }
+
+  /* only one write at a time to keep the order of the inputs */
+  ih_write_t* write = g_new0(ih_write_t, 1);
+  write->io         = g_object_ref(priv->io);
+  write->inputs     = inputs;
+  g_queue_push_tail(&priv->appends, write);
+  if (priv->appends.length == 1) {
+    ih_write_next(history);
+  }
+}
+
+static void ih_write(GiraraInputHistory* history, const char* input) {
+  girara_list_t* inputs = girara_list_new_with_free(g_free);
+  girara_list_append(inputs, g_strdup(input));
+  ih_write_batch(history, inputs);
+}
+
+static gboolean ih_flush_cb(gpointer data) {
+  GiraraInputHistory* history     = data;
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  priv->flush_idle                = 0;
+  priv->flush_timeout             = 0;
+  girara_input_history_flush(history);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void ih_flush(GiraraInputHistory* history) {
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  g_clear_handle_id(&priv->flush_idle, g_source_remove);
+  g_clear_handle_id(&priv->flush_timeout, g_source_remove);
+  if (girara_list_size(priv->unwritten) == 0) {
+    return;
+  }
+
+  if (priv->io == NULL) {
+    girara_list_reset(priv->unwritten);
+    return;
+  }
+
+  ih_write_batch(history, priv->unwritten);
+  priv->unwritten = girara_list_new_with_free(g_free);
+}
+
+static void ih_append(GiraraInputHistory* history, const char* input) {
+  if (input == NULL) {
+    return;
+  }
+
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  ih_store(priv, input);
+
   if (priv->io != NULL) {
-    girara_input_history_io_append(priv->io, input);
+    if (priv->flush_threshold == 0) {
+      ih_write(history, input);
+    } else {
+      /* collect the inputs and write them once enough came together or
+       * nothing else is going on */
+      girara_list_append(priv->unwritten, g_strdup(input));
+      if (girara_list_size(priv->unwritten) >= priv->flush_threshold) {
+        ih_flush(history);
+      } else if (priv->flush_idle == 0) {
+        priv->flush_idle = g_idle_add(ih_flush_cb, history);
+        if (priv->flush_interval != 0) {
+          priv->flush_timeout = g_timeout_add(priv->flush_interval, ih_flush_cb, history);
+        }
+      }
+    }
   }
 
   /* begin from the last command when navigating through history */
-  girara_input_history_reset(history);
+  priv->reset = true;
 }
 
 static girara_list_t* ih_list(GiraraInputHistory* history) {
   GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  if (priv->history_valid == false) {
+    girara_list_reset(priv->history);
+    for (size_t position = priv->first; position != ih_end(priv); ++position) {
+      char* input = *ih_entry(priv, position);
+      if (input != NULL) {
+        girara_list_append(priv->history, input);
+      }
+    }
+    priv->history_valid = true;
+  }
+
   return priv->history;
 }
 
-static const char* find_next(GiraraInputHistory* history, const char* current_input, bool next) {
+/* Find the closest match before or after a position. Returns G_MAXSIZE if
+ * there is none. */
+static size_t ih_find_match(GiraraInputHistoryPrivate* priv, size_t position, bool older) {
+  if (priv->match_all == true) {
+    while (older == true ? position-- > priv->first : ++position < ih_end(priv)) {
+      if (*ih_entry(priv, position) != NULL) {
+        return position;
+      }
+    }
+    return G_MAXSIZE;
+  }
+
+  if (priv->command_line == NULL) {
+    return G_MAXSIZE;
+  }
+  /* the inputs starting with the command-line are ranked by position */
+  return trie_find_rank(priv->inputs, priv->command_line, position, older);
+}
+
+/* Walk the list of a subclass that overrides it. */
+static const char* find_next_in_list(GiraraInputHistory* history, const char* current_input, bool next) {
   GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
 
   girara_list_t* list = girara_input_history_list(history);
@@ -226,6 +643,50 @@ static const char* find_next(GiraraInputHistory* history, const char* current_in
   return command;
 }
 
+static const char* find_next(GiraraInputHistory* history, const char* current_input, bool next) {
+  /* The index only knows the stored inputs, not those of an overridden list. */
+  if (GIRARA_INPUT_HISTORY_GET_CLASS(history)->list != ih_list) {
+    return find_next_in_list(history, current_input, next);
+  }
+
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  if (g_hash_table_size(priv->index) == 0) {
+    return NULL;
+  }
+
+  const size_t length = ih_end(priv);
+  if (priv->reset == true) {
+    priv->current_match = length;
+  }
+
+  /* Before moving into the history, save the current command-line. */
+  if (priv->current_match == length) {
+    g_free(priv->command_line);
+    priv->command_line = g_strdup(current_input);
+    /* Only match history items starting with what was on the command-line. */
+    priv->match_all = priv->command_line != NULL && priv->command_line[0] == '\0';
+  }
+
+  if (priv->reset == true || next == false) {
+    const size_t match = ih_find_match(priv, priv->current_match, true);
+    priv->reset        = false;
+    if (match == G_MAXSIZE) {
+      return NULL;
+    }
+    priv->current_match = match;
+  } else {
+    const size_t match = ih_find_match(priv, priv->current_match, false);
+    if (match == G_MAXSIZE) {
+      /* At the bottom of the history, return what the command-line was. */
+      priv->current_match = length;
+      return priv->command_line;
+    }
+    priv->current_match = match;
+  }
+
+  return *ih_entry(priv, priv->current_match);
+}
+
 static const char* ih_next(GiraraInputHistory* history, const char* current_input) {
   return find_next(history, current_input, true);
 }
@@ -234,22 +695,450 @@ static const char* ih_previous(GiraraInputHistory* history, const char* current_
   return find_next(history, current_input, false);
 }
 
+/* Store the inputs read from io. Navigation carries on from the current
+ * match unless it was moved or evicted. */
+static void ih_load(GiraraInputHistoryPrivate* priv, girara_list_t* newlist, bool reload) {
+  if (reload == true) {
+    ih_clear(priv);
+    priv->reset = true;
+  }
+
+  if (newlist != NULL) {
+    for (size_t idx = 0; idx != girara_list_size(newlist); ++idx) {
+      const char* input = girara_list_nth(newlist, idx);
+      if (input != NULL) {
+        ih_store(priv, input);
+      }
+    }
+  }
+
+  /* inputs that are not written yet are still the most recent ones */
+  for (GList* iter = priv->appends.head; iter != NULL; iter = iter->next) {
+    const ih_write_t* write = iter->data;
+    for (size_t idx = 0; idx != girara_list_size(write->inputs); ++idx) {
+      ih_store(priv, girara_list_nth(write->inputs, idx));
+    }
+  }
+  for (size_t idx = 0; idx != girara_list_size(priv->unwritten); ++idx) {
+    ih_store(priv, girara_list_nth(priv->unwritten, idx));
+  }
+}
+
+static void ih_read(GiraraInputHistory* history);
+
+static void ih_read_done(GObject* source, GAsyncResult* result, gpointer data) {
+  GiraraInputHistory* history     = data;
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  GiraraInputHistoryIO* io        = GIRARA_INPUT_HISTORY_IO(source);
+  priv->reading                   = false;
+
+  guint64 cursor                   = 0;
+  bool reload                      = false;
+  g_autoptr(GError) error          = NULL;
+  g_autoptr(girara_list_t) newlist = girara_input_history_io_read_finish(io, result, &cursor, &reload, &error);
+  if (error != NULL) {
+    girara_warning("Failed to read input history: %s", error->message);
+  } else if (io == priv->io) {
+    priv->cursor = cursor;
+    ih_load(priv, newlist, reload);
+  }
+
+  if (priv->read_again == true) {
+    priv->read_again = false;
+    ih_read(history);
+  }
+  g_object_unref(history);
+}
+
+/* Read from io in the background. The history is kept alive until the read
+ * is done. */
+static void ih_read(GiraraInputHistory* history) {
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  if (priv->io == NULL) {
+    return;
+  }
+  if (priv->reading == true) {
+    priv->read_again = true;
+    return;
+  }
+
+  priv->reading = true;
+  girara_input_history_io_read_async(priv->io, priv->cursor, NULL, ih_read_done, g_object_ref(history));
+}
+
+/* Pick up what was added to the storage since the last read. */
+static void ih_sync(GiraraInputHistory* history) {
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  if (priv->io == NULL) {
+    return;
+  }
+
+  if (ih_io_is_async(priv->io) == true) {
+    ih_read(history);
+    return;
+  }
+
+  bool reload                      = false;
+  g_autoptr(girara_list_t) newlist = girara_input_history_io_read_since(priv->io, &priv->cursor, &reload);
+  ih_load(priv, newlist, reload);
+}
+
+static void ih_io_changed(GiraraInputHistoryIO* GIRARA_UNUSED(io), GiraraInputHistory* history) {
+  ih_sync(history);
+}
+
 static void ih_reset(GiraraInputHistory* history) {
   GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
   priv->reset                     = true;
+  ih_sync(history);
+}
 
-  if (priv->io != NULL) {
-    girara_list_t* list = girara_input_history_list(history);
-    if (list == NULL) {
-      return;
+/**
+ * A match found by searching the stored inputs
+ */
+typedef struct ih_result_s {
+  int score;
+  size_t position;
+} ih_result_t;
+
+/* Higher scores are better, and so are more recent inputs with equal scores. */
+static bool ih_result_better(const ih_result_t* lhs, const ih_result_t* rhs) {
+  return lhs->score != rhs->score ? lhs->score > rhs->score : lhs->position > rhs->position;
+}
+
+static int ih_compare_results(const void* lhs, const void* rhs) {
+  return ih_result_better(lhs, rhs) == true ? -1 : ih_result_better(rhs, lhs) == true;
+}
+
+/* Keep the best max_results results in a heap with the worst one on top.
+ * Returns whether the result was kept. */
+static bool ih_results_add(GArray* results, size_t max_results, ih_result_t result) {
+  if (max_results == 0) {
+    g_array_append_val(results, result);
+    return true;
+  }
+
+  ih_result_t* heap = (ih_result_t*)results->data;
+  size_t idx        = results->len;
+  if (idx < max_results) {
+    g_array_append_val(results, result);
+    heap = (ih_result_t*)results->data;
+    while (idx != 0 && ih_result_better(&heap[(idx - 1) / 2], &result) == true) {
+      heap[idx] = heap[(idx - 1) / 2];
+      idx       = (idx - 1) / 2;
     }
-    girara_list_clear(list);
+    heap[idx] = result;
+    return true;
+  }
 
-    g_autoptr(girara_list_t) newlist = girara_input_history_io_read(priv->io);
-    if (newlist != NULL) {
-      girara_list_merge(list, newlist);
+  if (ih_result_better(&result, &heap[0]) == false) {
+    return false;
+  }
+  for (idx = 0; 2 * idx + 1 < results->len;) {
+    size_t child = 2 * idx + 1;
+    if (child + 1 < results->len && ih_result_better(&heap[child], &heap[child + 1]) == true) {
+      ++child;
     }
+    if (ih_result_better(&heap[child], &result) == true) {
+      break;
+    }
+    heap[idx] = heap[child];
+    idx       = child;
   }
+  heap[idx] = result;
+  return true;
+}
+
+/**
+ * Part of the stored inputs searched by one thread
+ */
+typedef struct ih_search_task_s {
+  GiraraInputHistoryPrivate* priv;
+  const fuzzy_pattern_t* pattern;
+  size_t begin;       /**< First position to search */
+  size_t end;         /**< Position after the last one to search */
+  size_t max_results; /**< Number of results to keep, 0 for all */
+  GArray* results;    /**< Best results found so far, see ih_results_add */
+} ih_search_task_t;
+
+static bool ih_search_match(size_t position, int score, void* data) {
+  ih_search_task_t* task   = data;
+  const ih_result_t result = {.score = score, .position = position};
+  return ih_results_add(task->results, task->max_results, result);
+}
+
+/* Score an input and return false once no older input can be among the
+ * results. */
+static bool ih_search_input(ih_search_task_t* task, size_t position, const char* input) {
+  int score = 0;
+  if (fuzzy_match(task->pattern, input, &score) == false) {
+    return true;
+  }
+
+  ih_search_match(position, score, task);
+
+  /* older inputs lose ties, so results with the highest possible score cannot
+   * be replaced */
+  const ih_result_t* worst = (const ih_result_t*)task->results->data;
+  return task->max_results == 0 || task->results->len != task->max_results || worst->score < task->pattern->max_score;
+}
+
+static void ih_search_task(gpointer data, gpointer GIRARA_UNUSED(user_data)) {
+  ih_search_task_t* task          = data;
+  GiraraInputHistoryPrivate* priv = task->priv;
+  const guint64 mask              = task->pattern->mask;
+
+  /* The positions are stored in at most two runs of slots. Going from the
+   * newest input to the oldest one, ties never replace results in a full heap.
+   * Most inputs lack some character of the query, which is cheap to check. */
+  for (size_t position = task->end; position != task->begin;) {
+    const size_t last    = ih_slot(priv, position - 1);
+    const size_t count   = MIN(position - task->begin, last + 1);
+    const guint64* masks = priv->masks + last + 1 - count;
+    char* const* entries = priv->entries + last + 1 - count;
+    position -= count;
+    for (size_t idx = count; idx-- != 0;) {
+      if ((masks[idx] & mask) == mask && entries[idx] != NULL &&
+          ih_search_input(task, position + idx, entries[idx]) == false) {
+        return;
+      }
+    }
+  }
+}
+
+/* Search the prefix index, or the subtrees of it given by within. The nodes
+ * below which all matches lie are appended to nodes unless it is NULL.
+ * Returns NULL if the search visits too many nodes to be faster than scanning
+ * the inputs. */
+static GArray* ih_search_index(GiraraInputHistoryPrivate* priv, const fuzzy_pattern_t* pattern, const GArray* within,
+                               size_t max_results, GArray* nodes) {
+  ih_search_task_t task = {
+      .pattern     = pattern,
+      .max_results = max_results,
+      .results     = g_array_new(FALSE, FALSE, sizeof(ih_result_t)),
+  };
+  const size_t budget = MAX(priv->n_entries / IH_SEARCH_INPUTS_PER_NODE, IH_SEARCH_MIN_NODES);
+  if (trie_fuzzy_search(priv->inputs, pattern, within, nodes, max_results != 0, budget, ih_search_match, &task) ==
+      false) {
+    g_array_unref(task.results);
+    return NULL;
+  }
+
+  return task.results;
+}
+
+/* Scan all inputs. */
+static GArray* ih_search_scan(GiraraInputHistoryPrivate* priv, const fuzzy_pattern_t* pattern, size_t max_results,
+                              unsigned int n_threads) {
+  const size_t size = priv->n_entries;
+  if (size == 0) {
+    return g_array_new(FALSE, FALSE, sizeof(ih_result_t));
+  }
+
+  /* small histories are not worth starting threads */
+  if (n_threads == 0) {
+    n_threads = g_get_num_processors();
+  }
+  const size_t n_tasks    = CLAMP(size / IH_SEARCH_MIN_PER_THREAD, 1, n_threads);
+  ih_search_task_t* tasks = g_new(ih_search_task_t, n_tasks);
+  for (size_t idx = 0; idx != n_tasks; ++idx) {
+    tasks[idx].priv        = priv;
+    tasks[idx].pattern     = pattern;
+    tasks[idx].begin       = ih_end(priv) - (idx + 1) * size / n_tasks;
+    tasks[idx].end         = ih_end(priv) - idx * size / n_tasks;
+    tasks[idx].max_results = max_results;
+    tasks[idx].results     = g_array_new(FALSE, FALSE, sizeof(ih_result_t));
+  }
+
+  if (n_tasks > 1) {
+    /* the calling thread searches the first part itself */
+    GThreadPool* pool = g_thread_pool_new(ih_search_task, NULL, n_tasks - 1, FALSE, NULL);
+    for (size_t idx = 1; idx != n_tasks; ++idx) {
+      if (pool == NULL || g_thread_pool_push(pool, &tasks[idx], NULL) == FALSE) {
+        ih_search_task(&tasks[idx], NULL);
+      }
+    }
+    ih_search_task(&tasks[0], NULL);
+    if (pool != NULL) {
+      g_thread_pool_free(pool, FALSE, TRUE);
+    }
+  } else {
+    ih_search_task(&tasks[0], NULL);
+  }
+
+  GArray* results = tasks[0].results;
+  for (size_t idx = 1; idx != n_tasks; ++idx) {
+    for (size_t result = 0; result != tasks[idx].results->len; ++result) {
+      ih_results_add(results, max_results, g_array_index(tasks[idx].results, ih_result_t, result));
+    }
+    g_array_unref(tasks[idx].results);
+  }
+  g_free(tasks);
+
+  return results;
+}
+
+/* Search the inputs below the given nodes of the prefix index, or all inputs
+ * if within is NULL, and return the best max_results matches, best match
+ * first. Unless nodes is NULL, it is set to the nodes below which all matches
+ * lie, or to NULL if the inputs had to be scanned. */
+static GArray* ih_search_results(GiraraInputHistoryPrivate* priv, const char* query, const GArray* within,
+                                 size_t max_results, unsigned int n_threads, GArray** nodes) {
+  fuzzy_pattern_t pattern;
+  fuzzy_pattern_init(&pattern, query);
+
+  /* most queries only occur at a few nodes of the prefix index; the others
+   * are faster to find by scanning the inputs */
+  GArray* found   = nodes != NULL ? g_array_new(FALSE, FALSE, sizeof(girara_tree_node_t*)) : NULL;
+  GArray* results = ih_search_index(priv, &pattern, within, max_results, found);
+  if (results == NULL) {
+    g_clear_pointer(&found, g_array_unref);
+    results = ih_search_scan(priv, &pattern, max_results, n_threads);
+  }
+  fuzzy_pattern_clear(&pattern);
+  if (nodes != NULL) {
+    *nodes = found;
+  }
+
+  g_array_sort(results, ih_compare_results);
+  return results;
+}
+
+/* Copy the inputs of search results into a list. */
+static girara_list_t* ih_results_list(GiraraInputHistoryPrivate* priv, const GArray* results) {
+  girara_list_t* list = girara_list_new_with_free(g_free);
+  for (size_t idx = 0; idx != results->len; ++idx) {
+    girara_list_append(list, g_strdup(*ih_entry(priv, g_array_index(results, ih_result_t, idx).position)));
+  }
+
+  return list;
+}
+
+static girara_list_t* ih_search(GiraraInputHistory* history, const char* query, size_t max_results,
+                                unsigned int n_threads) {
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(history);
+  g_autoptr(GArray) results       = ih_search_results(priv, query, NULL, max_results, n_threads, NULL);
+  return ih_results_list(priv, results);
+}
+
+/* Search sessions */
+
+/**
+ * Inputs matching a prefix of the query of a search session
+ */
+typedef struct ih_search_level_s {
+  size_t length;      /**< Length of the prefix */
+  GArray* nodes;      /**< Nodes of the prefix index below which all matches lie, NULL if unknown */
+  GArray* results;    /**< Best matches of the prefix, see ih_search_results */
+  size_t max_results; /**< Number of results that were asked for */
+} ih_search_level_t;
+
+struct girara_input_history_search_session_s {
+  GiraraInputHistory* history;
+  char* query;      /**< The last query */
+  GArray* levels;   /**< Matches of prefixes of the last query, shortest prefix first */
+  guint64 revision; /**< Revision of the history the nodes refer to */
+  gint ref_count;
+};
+
+G_DEFINE_BOXED_TYPE(GiraraInputHistorySearchSession, girara_input_history_search_session,
+                    girara_input_history_search_session_ref, girara_input_history_search_session_unref)
+
+static void ih_search_level_clear(void* data) {
+  ih_search_level_t* level = data;
+  if (level->nodes != NULL) {
+    g_array_unref(level->nodes);
+  }
+  g_array_unref(level->results);
+}
+
+GiraraInputHistorySearchSession* girara_input_history_search_session_new(GiraraInputHistory* history) {
+  g_return_val_if_fail(GIRARA_IS_INPUT_HISTORY(history), NULL);
+
+  GiraraInputHistoryPrivate* priv          = girara_input_history_get_instance_private(history);
+  GiraraInputHistorySearchSession* session = g_new0(GiraraInputHistorySearchSession, 1);
+  session->history                         = g_object_ref(history);
+  session->levels                          = g_array_new(FALSE, FALSE, sizeof(ih_search_level_t));
+  session->revision                        = priv->revision;
+  session->ref_count                       = 1;
+  g_array_set_clear_func(session->levels, ih_search_level_clear);
+
+  return session;
+}
+
+GiraraInputHistorySearchSession* girara_input_history_search_session_ref(GiraraInputHistorySearchSession* session) {
+  g_return_val_if_fail(session != NULL, NULL);
+
+  g_atomic_int_inc(&session->ref_count);
+  return session;
+}
+
+girara_list_t* girara_input_history_search_session_update(GiraraInputHistorySearchSession* session,
+                                                          const char* query, size_t max_results) {
+  g_return_val_if_fail(session != NULL, NULL);
+  g_return_val_if_fail(query != NULL, NULL);
+  GiraraInputHistoryPrivate* priv = girara_input_history_get_instance_private(session->history);
+
+  /* nodes are only valid until the history changes */
+  if (session->revision != priv->revision) {
+    g_array_set_size(session->levels, 0);
+    session->revision = priv->revision;
+  }
+
+  /* drop the matches of prefixes that were removed from the query */
+  size_t common = 0;
+  if (session->query != NULL) {
+    while (query[common] != '\0' && query[common] == session->query[common]) {
+      ++common;
+    }
+  }
+  while (session->levels->len != 0 &&
+         g_array_index(session->levels, ih_search_level_t, session->levels->len - 1).length > common) {
+    g_array_remove_index(session->levels, session->levels->len - 1);
+  }
+  g_free(session->query);
+  session->query = g_strdup(query);
+
+  const size_t length  = strlen(query);
+  const GArray* within = NULL;
+  if (session->levels->len != 0) {
+    ih_search_level_t* level = &g_array_index(session->levels, ih_search_level_t, session->levels->len - 1);
+    if (level->length == length) {
+      /* the query was searched before, e.g. before typing and removing a
+       * character */
+      if (level->max_results != max_results) {
+        g_array_unref(level->results);
+        level->results     = ih_search_results(priv, query, level->nodes, max_results, 0, NULL);
+        level->max_results = max_results;
+      }
+      return ih_results_list(priv, level->results);
+    }
+    within = level->nodes;
+  } else if (length == 0) {
+    g_autoptr(GArray) results = ih_search_results(priv, query, NULL, max_results, 0, NULL);
+    return ih_results_list(priv, results);
+  }
+
+  /* inputs matching the query also match every prefix of it, so only the
+   * matches of the longest known prefix need to be searched, unless the
+   * inputs had to be scanned for it; scans use all processors, as a query is
+   * searched on every keystroke */
+  ih_search_level_t level = {.length = length, .max_results = max_results};
+  level.results           = ih_search_results(priv, query, within, max_results, 0, &level.nodes);
+  g_array_append_val(session->levels, level);
+
+  return ih_results_list(priv, level.results);
+}
+
+void girara_input_history_search_session_unref(GiraraInputHistorySearchSession* session) {
+  if (session == NULL || g_atomic_int_dec_and_test(&session->ref_count) == FALSE) {
+    return;
+  }
+
+  g_array_unref(session->levels);
+  g_free(session->query);
+  g_object_unref(session->history);
+  g_free(session);
 }
 
 /* Wrapper functions for the members */
@@ -286,3 +1175,27 @@ void girara_input_history_reset(GiraraInputHistory* history) {
 
   klass->reset(history);
 }
+
+void girara_input_history_flush(GiraraInputHistory* history) {
+  g_return_if_fail(history != NULL);
+
+  GiraraInputHistoryClass* klass = GIRARA_INPUT_HISTORY_GET_CLASS(history);
+  g_return_if_fail(klass != NULL && klass->flush != NULL);
+
+  klass->flush(history);
+}
+
+girara_list_t* girara_input_history_search(GiraraInputHistory* history, const char* query, size_t max_results) {
+  return girara_input_history_search_parallel(history, query, max_results, 1);
+}
+
+girara_list_t* girara_input_history_search_parallel(GiraraInputHistory* history, const char* query,
+                                                    size_t max_results, unsigned int n_threads) {
+  g_return_val_if_fail(history != NULL, NULL);
+  g_return_val_if_fail(query != NULL, NULL);
+
+  GiraraInputHistoryClass* klass = GIRARA_INPUT_HISTORY_GET_CLASS(history);
+  g_return_val_if_fail(klass != NULL && klass->search != NULL, NULL);
+
+  return klass->search(history, query, max_results, n_threads);
+}
@@ -4,10 +4,15 @@
 #define GIRARA_INPUT_HISTORY_H
 
 #include <glib-object.h>
+#include <gio/gio.h>
 
 #include "types.h"
 #include "macros.h"
 
+/**
+ * Interface of input history storage. Storage that can be changed by others,
+ * e.g. by other processes, emits the "changed" signal when inputs were added.
+ */
 struct girara_input_history_io_interface_s {
   GTypeInterface parent_iface;
 
@@ -29,11 +34,119 @@ struct girara_input_history_io_interface_s {
    */
   girara_list_t* (*read)(GiraraInputHistoryIO* io);
 
-  /* reserved for further methods */
-  void (*reserved1)(void);
-  void (*reserved2)(void);
-  void (*reserved3)(void);
-  void (*reserved4)(void);
+  /**
+   * Read the items that were added to the input history storage since a
+   * previous read. If the storage was changed in any other way, e.g. if it was
+   * rewritten, all items are returned instead. This method is optional.
+   *
+   * @param io a GiraraInputHistoryIO object
+   * @param cursor position after the previously read items, 0 to read all
+   * items; updated to the position after the returned items
+   * @param reload set to true if all items are returned
+   * @returns a list of inputs
+   */
+  girara_list_t* (*read_since)(GiraraInputHistoryIO* io, guint64* cursor, bool* reload);
+
+  /**
+   * Remove an input that was evicted from the input history from the input
+   * history storage. This method is optional.
+   *
+   * @param io a GiraraInputHistoryIO object
+   * @param input the evicted input
+   */
+  void (*evict)(GiraraInputHistoryIO* io, const char* input);
+
+  /**
+   * Asynchronously write a line of input to the input history storage. This
+   * method is optional. It is set together with append_finish.
+   *
+   * @param io a GiraraInputHistoryIO object
+   * @param input the input
+   * @param cancellable a GCancellable, may be NULL
+   * @param callback callback to call when the input was written
+   * @param user_data data passed to the callback
+   */
+  void (*append_async)(GiraraInputHistoryIO* io, const char* input, GCancellable* cancellable,
+                       GAsyncReadyCallback callback, gpointer user_data);
+
+  /**
+   * Finish writing a line of input started with append_async.
+   *
+   * @param io a GiraraInputHistoryIO object
+   * @param result the GAsyncResult passed to the callback
+   * @param error return location for an error
+   * @returns true if the input was written
+   */
+  bool (*append_finish)(GiraraInputHistoryIO* io, GAsyncResult* result, GError** error);
+
+  /**
+   * Asynchronously read the items that were added to the input history
+   * storage since a previous read, see read_since. This method is optional.
+   * It is set together with read_finish.
+   *
+   * @param io a GiraraInputHistoryIO object
+   * @param cursor position after the previously read items, 0 to read all
+   * items
+   * @param cancellable a GCancellable, may be NULL
+   * @param callback callback to call when the items were read
+   * @param user_data data passed to the callback
+   */
+  void (*read_async)(GiraraInputHistoryIO* io, guint64 cursor, GCancellable* cancellable, GAsyncReadyCallback callback,
+                     gpointer user_data);
+
+  /**
+   * Finish reading items started with read_async.
+   *
+   * @param io a GiraraInputHistoryIO object
+   * @param result the GAsyncResult passed to the callback
+   * @param cursor set to the position after the returned items
+   * @param reload set to true if all items are returned
+   * @param error return location for an error
+   * @returns a list of inputs or NULL on error
+   */
+  girara_list_t* (*read_finish)(GiraraInputHistoryIO* io, GAsyncResult* result, guint64* cursor, bool* reload,
+                                GError** error);
+
+  /**
+   * Write several lines of input to the input history storage at once. This
+   * method is optional.
+   *
+   * @param io a GiraraInputHistoryIO object
+   * @param inputs list of inputs, oldest first
+   * @param cursor position after the items read so far, may be NULL; if
+   * nothing else was added to the storage since, it is moved past the written
+   * inputs so that read_since does not return them again
+   */
+  void (*append_batch)(GiraraInputHistoryIO* io, girara_list_t* inputs, guint64* cursor);
+
+  /**
+   * Asynchronously write several lines of input to the input history storage
+   * at once, see append_batch. This method is optional. It is set together
+   * with append_batch_finish.
+   *
+   * @param io a GiraraInputHistoryIO object
+   * @param inputs list of inputs, oldest first; it has to stay valid until the
+   * callback is called
+   * @param cursor position after the items read so far
+   * @param cancellable a GCancellable, may be NULL
+   * @param callback callback to call when the inputs were written
+   * @param user_data data passed to the callback
+   */
+  void (*append_batch_async)(GiraraInputHistoryIO* io, girara_list_t* inputs, guint64 cursor,
+                             GCancellable* cancellable, GAsyncReadyCallback callback, gpointer user_data);
+
+  /**
+   * Finish writing inputs started with append_batch_async.
+   *
+   * @param io a GiraraInputHistoryIO object
+   * @param result the GAsyncResult passed to the callback
+   * @param cursor set to the position after the written inputs if nothing else
+   * was added to the storage since the cursor passed to append_batch_async,
+   * otherwise to that cursor
+   * @param error return location for an error
+   * @returns true if the inputs were written
+   */
+  bool (*append_batch_finish)(GiraraInputHistoryIO* io, GAsyncResult* result, guint64* cursor, GError** error);
 };
 
 #define GIRARA_TYPE_INPUT_HISTORY_IO (girara_input_history_io_get_type())
@@ -49,6 +162,33 @@ void girara_input_history_io_append(GiraraInputHistoryIO* io, const char* input)
 
 girara_list_t* girara_input_history_io_read(GiraraInputHistoryIO* io) GIRARA_VISIBLE;
 
+girara_list_t* girara_input_history_io_read_since(GiraraInputHistoryIO* io, guint64* cursor,
+                                                  bool* reload) GIRARA_VISIBLE;
+
+void girara_input_history_io_evict(GiraraInputHistoryIO* io, const char* input) GIRARA_VISIBLE;
+
+void girara_input_history_io_append_async(GiraraInputHistoryIO* io, const char* input, GCancellable* cancellable,
+                                          GAsyncReadyCallback callback, gpointer user_data) GIRARA_VISIBLE;
+
+bool girara_input_history_io_append_finish(GiraraInputHistoryIO* io, GAsyncResult* result,
+                                           GError** error) GIRARA_VISIBLE;
+
+void girara_input_history_io_read_async(GiraraInputHistoryIO* io, guint64 cursor, GCancellable* cancellable,
+                                        GAsyncReadyCallback callback, gpointer user_data) GIRARA_VISIBLE;
+
+girara_list_t* girara_input_history_io_read_finish(GiraraInputHistoryIO* io, GAsyncResult* result, guint64* cursor,
+                                                   bool* reload, GError** error) GIRARA_VISIBLE;
+
+void girara_input_history_io_append_batch(GiraraInputHistoryIO* io, girara_list_t* inputs,
+                                          guint64* cursor) GIRARA_VISIBLE;
+
+void girara_input_history_io_append_batch_async(GiraraInputHistoryIO* io, girara_list_t* inputs, guint64 cursor,
+                                                GCancellable* cancellable, GAsyncReadyCallback callback,
+                                                gpointer user_data) GIRARA_VISIBLE;
+
+bool girara_input_history_io_append_batch_finish(GiraraInputHistoryIO* io, GAsyncResult* result, guint64* cursor,
+                                                 GError** error) GIRARA_VISIBLE;
+
 struct girara_input_history_s {
   GObject parent;
 };
@@ -60,7 +200,13 @@ struct girara_input_history_class_s {
 
   /**
    * Append a new line of input. If the io property is set, the input will
-   * be passed on to @ref girara_input_history_io_append.
+   * be passed on to @ref girara_input_history_io_append_batch, or to @ref
+   * girara_input_history_io_append_batch_async if the storage implements any
+   * asynchronous method. Inputs are written in the order they were appended.
+   * If the flush-threshold property is set, inputs are collected and written
+   * in batches, see @ref girara_input_history_flush. If the max-entries
+   * property is set, the oldest inputs are evicted and passed on to @ref
+   * girara_input_history_io_evict.
    *
    * @param history an input history instance
    * @param input the input
@@ -71,7 +217,8 @@ struct girara_input_history_class_s {
    * Get a list of all the inputs stored.
    *
    * @param history an input history instance
-   * @returns a list containing all inputs
+   * @returns a list containing all inputs, oldest first; it is owned by the
+   *   history and only valid until the history changes
    */
   girara_list_t* (*list)(GiraraInputHistory* history);
 
@@ -95,16 +242,39 @@ struct girara_input_history_class_s {
 
   /**
    * Reset state of the input history, i.e reset any information used to
-   * determine the next input. If the io property is set, the history will be
-   * re-read with @ref girara_input_history_io_read.
+   * determine the next input. If the io property is set, inputs added to the
+   * storage in the meantime are read with @ref
+   * girara_input_history_io_read_since, or in the background with @ref
+   * girara_input_history_io_read_async if the storage implements it. The
+   * same happens whenever the storage emits the "changed" signal.
    *
    * @param history an input history instance
    */
   void (*reset)(GiraraInputHistory* history);
 
+  /**
+   * Write the inputs that were collected since the last write. This happens
+   * by itself once flush-threshold inputs were collected, once the main loop
+   * is idle, after flush-interval milliseconds and when the input history is
+   * disposed.
+   *
+   * @param history an input history instance
+   */
+  void (*flush)(GiraraInputHistory* history);
+
+  /**
+   * Search the stored inputs for a query, see @ref
+   * girara_input_history_search_parallel.
+   *
+   * @param history an input history instance
+   * @param query the query
+   * @param max_results maximal number of results, 0 for all
+   * @param n_threads maximal number of threads or 0 to use one per processor
+   * @returns a list of matching inputs, best match first
+   */
+  girara_list_t* (*search)(GiraraInputHistory* history, const char* query, size_t max_results, unsigned int n_threads);
+
   /* reserved for further methods */
-  void (*reserved1)(void);
-  void (*reserved2)(void);
   void (*reserved3)(void);
   void (*reserved4)(void);
 };
@@ -167,11 +337,115 @@ const char* girara_input_history_previous(GiraraInputHistory* history, const cha
 void girara_input_history_reset(GiraraInputHistory* history) GIRARA_VISIBLE;
 
 /**
- * Get a list of all the inputs stored.
+ * Write the inputs that were collected since the last write
  *
  * @param history an input history instance
- * @returns a list containing all inputs
+ */
+void girara_input_history_flush(GiraraInputHistory* history) GIRARA_VISIBLE;
+
+/**
+ * Get a list of all the inputs stored. The list and the inputs are owned by
+ * the history. They are only valid until the next call that changes the
+ * history, that is appending, resetting or reading from the storage, and
+ * must not be modified or freed.
+ *
+ * @param history an input history instance
+ * @returns a list containing all inputs, oldest first
  */
 girara_list_t* girara_input_history_list(GiraraInputHistory* history) GIRARA_VISIBLE;
 
+/**
+ * Search the stored inputs for a query on the calling thread, see @ref
+ * girara_input_history_search_parallel.
+ *
+ * @param history an input history instance
+ * @param query the query
+ * @param max_results maximal number of results, 0 for all
+ * @returns a list of matching inputs, best match first
+ */
+girara_list_t* girara_input_history_search(GiraraInputHistory* history, const char* query,
+                                           size_t max_results) GIRARA_VISIBLE;
+
+/**
+ * Search the stored inputs for a query. Inputs match if they contain the
+ * characters of the query in the same order, not necessarily next to each
+ * other. Matches are ranked like fzf does: characters at the start of words
+ * and runs of consecutive characters score higher, gaps lower. Ties go to the
+ * more recent input. The query is case sensitive only if it contains upper
+ * case letters.
+ *
+ * When only a few results are asked for, inputs sharing a prefix are scored
+ * together, and the newest of them are taken first. Queries occurring in too
+ * many places fall back to scanning the inputs, newest first, until no older
+ * input can rank higher. Only the scan uses more than one thread. Searches as
+ * the query is typed are better done with @ref
+ * girara_input_history_search_session_update, which only searches where the
+ * previous query matched.
+ *
+ * @param history an input history instance
+ * @param query the query
+ * @param max_results maximal number of results, 0 for all
+ * @param n_threads maximal number of threads or 0 to use one per processor
+ * @returns a list of copies of the matching inputs, best match first; free it
+ *   with girara_list_free
+ */
+girara_list_t* girara_input_history_search_parallel(GiraraInputHistory* history, const char* query,
+                                                    size_t max_results, unsigned int n_threads) GIRARA_VISIBLE;
+
+#define GIRARA_TYPE_INPUT_HISTORY_SEARCH_SESSION (girara_input_history_search_session_get_type())
+
+/**
+ * Returns the type of input history search sessions.
+ *
+ * @return the type
+ */
+GType girara_input_history_search_session_get_type(void) GIRARA_VISIBLE;
+
+/**
+ * Create a new search session. A session searches the stored inputs like
+ * @ref girara_input_history_search while the query is being typed: once a
+ * query was searched, queries extending it only search the parts of the
+ * prefix index in which it matched, and removing characters again only
+ * searches all inputs if the query gets shorter than the first query
+ * searched. A query that had to be found by scanning the inputs, which uses
+ * one thread per processor, leaves the next one to be searched from scratch.
+ * Any change to the stored inputs starts over.
+ *
+ * @param history an input history instance
+ * @returns a search session, release it with @ref
+ *   girara_input_history_search_session_unref
+ */
+GiraraInputHistorySearchSession* girara_input_history_search_session_new(GiraraInputHistory* history) GIRARA_VISIBLE;
+
+/**
+ * Take a reference to a search session.
+ *
+ * @param session a search session
+ * @returns the session
+ */
+GiraraInputHistorySearchSession*
+girara_input_history_search_session_ref(GiraraInputHistorySearchSession* session) GIRARA_VISIBLE;
+
+/**
+ * Search the stored inputs for the current query of the session.
+ *
+ * @param session a search session
+ * @param query the query
+ * @param max_results maximal number of results, 0 for all
+ * @returns a list of copies of the matching inputs, best match first; free it
+ *   with girara_list_free
+ */
+girara_list_t* girara_input_history_search_session_update(GiraraInputHistorySearchSession* session,
+                                                          const char* query, size_t max_results) GIRARA_VISIBLE;
+
+/**
+ * Release a reference to a search session. The session is freed once the
+ * last reference is gone.
+ *
+ * @param session a search session
+ */
+void girara_input_history_search_session_unref(GiraraInputHistorySearchSession* session) GIRARA_VISIBLE;
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GiraraInputHistorySearchSession, girara_input_history_search_session_unref)
+
 #endif
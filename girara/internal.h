@@ -10,4 +10,63 @@
 
 int list_strcmp(const void* data1, const void* data2);
 
+girara_free_function_t node_get_free_function(girara_tree_node_t* node);
+void node_replace(girara_tree_node_t* node, girara_tree_node_t* replacement);
+size_t node_memory_usage(girara_tree_node_t* node);
+
+typedef void (*node_flat_visitor_t)(girara_tree_node_t* node, size_t index, size_t parent, void* userdata);
+bool node_walk_flat(girara_tree_node_t* root, size_t max_depth, node_flat_visitor_t visitor, void* userdata);
+
+girara_flat_tree_t* flat_tree_new(size_t size, girara_free_function_t gfree);
+void flat_tree_set_node(girara_flat_tree_t* tree, size_t index, void* data, size_t parent);
+void flat_tree_set_backing(girara_flat_tree_t* tree, GBytes* bytes);
+void flat_tree_finish(girara_flat_tree_t* tree);
+
+/**
+ * Ranks of trie entries. Every node knows the highest rank below it, so the
+ * entry with the closest rank below or above a given one is found without
+ * visiting all entries with a prefix. Entries inserted with
+ * girara_trie_insert have rank 0; the rank of an existing entry is kept when
+ * its value is replaced.
+ */
+typedef size_t (*trie_rank_function_t)(void* value, void* userdata);
+
+bool trie_insert_ranked(girara_trie_t* trie, const char* key, void* value, size_t rank);
+void trie_set_rank(girara_trie_t* trie, const char* key, size_t rank);
+void trie_set_ranks(girara_trie_t* trie, trie_rank_function_t rank, void* userdata);
+size_t trie_find_rank(const girara_trie_t* trie, const char* prefix, size_t rank, bool lower);
+
+/**
+ * Fuzzy matching of inputs, see input-history-search.c
+ */
+typedef struct fuzzy_pattern_s {
+  char* text;              /**< The query, in lower case unless case_sensitive is set */
+  size_t length;           /**< Length of the query */
+  bool case_sensitive;     /**< The query contains upper case letters */
+  guint64 mask;            /**< Characters of the query, see fuzzy_mask */
+  int max_score;           /**< No input scores higher */
+  unsigned char fold[256]; /**< Maps bytes of inputs to the case of the query */
+} fuzzy_pattern_t;
+
+guint64 fuzzy_mask(const char* text);
+void fuzzy_pattern_init(fuzzy_pattern_t* pattern, const char* query);
+void fuzzy_pattern_clear(fuzzy_pattern_t* pattern);
+bool fuzzy_match(const fuzzy_pattern_t* pattern, const char* input, int* score);
+
+/**
+ * Fuzzy search of the keys of a trie. Every node knows the characters below
+ * it, so subtrees lacking a character of the pattern are skipped, and entries
+ * sharing the key up to the first occurrence of the pattern are scored once.
+ * The entries below a node at which the pattern occurs are reported highest
+ * rank first if by_rank is set, and the rest of them are skipped once match
+ * returns false. Such nodes are appended to found unless it is NULL, and
+ * passing them as within of a later search only searches their subtrees.
+ * The search gives up and returns false after visiting budget nodes and
+ * entries, leaving the reported matches incomplete.
+ */
+typedef bool (*trie_match_function_t)(size_t rank, int score, void* userdata);
+
+bool trie_fuzzy_search(const girara_trie_t* trie, const fuzzy_pattern_t* pattern, const GArray* within, GArray* found,
+                       bool by_rank, size_t budget, trie_match_function_t match, void* userdata);
+
 #endif
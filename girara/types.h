@@ -7,6 +7,10 @@
 #include <stdbool.h>
 
 typedef struct girara_tree_node_s girara_tree_node_t;
+typedef struct girara_tree_pool_s girara_tree_pool_t;
+typedef struct girara_flat_tree_s girara_flat_tree_t;
+typedef struct girara_trie_s girara_trie_t;
+typedef struct girara_trie_iter_s girara_trie_iter_t;
 typedef struct girara_list_s girara_list_t;
 typedef struct girara_list_iterator_s girara_list_iterator_t;
 
@@ -25,6 +29,14 @@ typedef void (*girara_free_function_t)(void* data);
  */
 typedef void (*girara_list_callback_t)(void* data, void* userdata);
 
+/** Function declaration of a function called as callback from girara_node_*
+ * functions.
+ *
+ * @param node a tree node.
+ * @param userdata data passed as userdata to the calling function.
+ */
+typedef void (*girara_node_callback_t)(girara_tree_node_t* node, void* userdata);
+
 /** Function declaration of a function which compares two elements.
  *
  * @param data1 the first element.
@@ -39,5 +51,8 @@ typedef struct girara_input_history_io_s GiraraInputHistoryIO;
 typedef struct girara_input_history_io_interface_s GiraraInputHistoryIOInterface;
 typedef struct girara_input_history_s GiraraInputHistory;
 typedef struct girara_input_history_class_s GiraraInputHistoryClass;
+typedef struct girara_input_history_search_session_s GiraraInputHistorySearchSession;
+typedef struct girara_input_history_file_io_s GiraraInputHistoryFileIO;
+typedef struct girara_input_history_file_io_class_s GiraraInputHistoryFileIOClass;
 
 #endif
@@ -2,6 +2,7 @@
 
 #include <glib.h>
 #include <stdint.h>
+#include <string.h>
 #include <datastructures.h>
 #include <macros.h>
 #include <log.h>
@@ -188,6 +189,45 @@ static void test_datastructures_list_free_free_function_remove(void) {
   g_assert_cmpuint(list_free_called, ==, 1);
 }
 
+static void test_datastructures_list_reset(void) {
+  girara_list_t* list = girara_list_new_with_free(g_free);
+  g_assert_nonnull(list);
+  g_assert_cmpuint(girara_list_capacity(list), ==, 0);
+
+  for (unsigned int i = 0; i != 100; ++i) {
+    girara_list_append(list, g_strdup_printf("%u", i));
+  }
+  g_assert_cmpuint(girara_list_high_water_mark(list), ==, 100);
+  const size_t capacity = girara_list_capacity(list);
+  g_assert_cmpuint(capacity, >=, 100);
+
+  // reset keeps the storage
+  girara_list_reset(list);
+  g_assert_cmpuint(girara_list_size(list), ==, 0);
+  g_assert_cmpuint(girara_list_capacity(list), ==, capacity);
+
+  // refilling up to the high-water mark does not grow the list
+  for (unsigned int i = 0; i != 100; ++i) {
+    girara_list_prepend(list, g_strdup_printf("%u", i));
+  }
+  g_assert_cmpuint(girara_list_capacity(list), ==, capacity);
+  g_assert_cmpstr(girara_list_nth(list, 0), ==, "99");
+  g_assert_cmpuint(girara_list_high_water_mark(list), ==, 100);
+
+  // retained capacity can be limited
+  girara_list_set_max_retained_capacity(list, 16);
+  girara_list_reset(list);
+  g_assert_cmpuint(girara_list_size(list), ==, 0);
+  g_assert_cmpuint(girara_list_capacity(list), ==, 16);
+  g_assert_cmpuint(girara_list_high_water_mark(list), ==, 100);
+
+  // clear releases everything
+  girara_list_append(list, g_strdup("a"));
+  girara_list_clear(list);
+  g_assert_cmpuint(girara_list_capacity(list), ==, 0);
+  girara_list_free(list);
+}
+
 static void test_datastructures_sorted_list_basic(void) {
   girara_list_t* list = girara_sorted_list_new(NULL);
   g_assert_nonnull(list);
@@ -229,6 +269,235 @@ static void test_datastructures_sorted_list(void) {
   girara_list_free(unsorted_list);
 }
 
+static int compare_string(const void* data1, const void* data2) {
+  return g_strcmp0(data1, data2);
+}
+
+static int compare_int(const void* data1, const void* data2) {
+  const intptr_t lhs = (intptr_t)data1;
+  const intptr_t rhs = (intptr_t)data2;
+
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+static girara_list_t* random_int_list(size_t size, intptr_t range) {
+  girara_list_t* list = girara_list_new();
+  g_assert_nonnull(list);
+
+  GRand* rand = g_rand_new_with_seed(42);
+  for (size_t idx = 0; idx != size; ++idx) {
+    girara_list_append(list, (void*)(intptr_t)g_rand_int_range(rand, 0, range));
+  }
+  g_rand_free(rand);
+
+  return list;
+}
+
+static girara_list_t* sorted_copy(girara_list_t* list) {
+  girara_list_t* copy = girara_list_new();
+  g_assert_nonnull(copy);
+  for (size_t idx = 0; idx != girara_list_size(list); ++idx) {
+    girara_list_append(copy, girara_list_nth(list, idx));
+  }
+  girara_list_sort(copy, compare_int);
+
+  return copy;
+}
+
+static void test_datastructures_list_partial_sort(void) {
+  static const size_t sizes[] = {0, 1, 10, 100, 1000};
+  static const size_t ks[]    = {0, 1, 5, 20, 50, 1000};
+
+  for (size_t s = 0; s != G_N_ELEMENTS(sizes); ++s) {
+    for (size_t t = 0; t != G_N_ELEMENTS(ks); ++t) {
+      girara_list_t* list     = random_int_list(sizes[s], 100);
+      girara_list_t* expected = sorted_copy(list);
+
+      girara_list_partial_sort(list, ks[t], compare_int);
+      g_assert_cmpuint(girara_list_size(list), ==, sizes[s]);
+      const size_t k = MIN(ks[t], sizes[s]);
+      for (size_t idx = 0; idx != k; ++idx) {
+        g_assert_cmpint((intptr_t)girara_list_nth(list, idx), ==, (intptr_t)girara_list_nth(expected, idx));
+      }
+      for (size_t idx = k; idx < sizes[s]; ++idx) {
+        if (k > 0) {
+          g_assert_cmpint((intptr_t)girara_list_nth(list, idx), >=, (intptr_t)girara_list_nth(list, k - 1));
+        }
+      }
+
+      girara_list_free(expected);
+      girara_list_free(list);
+    }
+  }
+}
+
+static void test_datastructures_list_select_nth(void) {
+  static const intptr_t ranges[] = {1, 3, 1000000};
+
+  for (size_t r = 0; r != G_N_ELEMENTS(ranges); ++r) {
+    girara_list_t* list     = random_int_list(2000, ranges[r]);
+    girara_list_t* expected = sorted_copy(list);
+
+    for (size_t n = 0; n < 2000; n += 97) {
+      const intptr_t nth = (intptr_t)girara_list_select_nth(list, n, compare_int);
+      g_assert_cmpint(nth, ==, (intptr_t)girara_list_nth(expected, n));
+      g_assert_cmpint((intptr_t)girara_list_nth(list, n), ==, nth);
+      for (size_t idx = 0; idx != 2000; ++idx) {
+        const intptr_t value = (intptr_t)girara_list_nth(list, idx);
+        if (idx < n) {
+          g_assert_cmpint(value, <=, nth);
+        } else {
+          g_assert_cmpint(value, >=, nth);
+        }
+      }
+    }
+
+    girara_list_free(expected);
+    girara_list_free(list);
+  }
+
+  /* already sorted input */
+  girara_list_t* list = girara_list_new();
+  for (intptr_t i = 0; i != 1000; ++i) {
+    girara_list_append(list, (void*)i);
+  }
+  g_assert_cmpint((intptr_t)girara_list_select_nth(list, 500, compare_int), ==, 500);
+  girara_list_free(list);
+}
+
+static void test_datastructures_list_partial_sort_benchmark(void) {
+  girara_list_t* list = random_int_list(1000000, G_MAXINT32);
+  girara_list_t* copy = girara_list_new();
+  for (size_t idx = 0; idx != girara_list_size(list); ++idx) {
+    girara_list_append(copy, girara_list_nth(list, idx));
+  }
+
+  g_test_timer_start();
+  girara_list_partial_sort(list, 50, compare_int);
+  g_test_minimized_result(g_test_timer_elapsed(), "partial sort of 10^6 elements, k=50: %.3fs",
+                          g_test_timer_elapsed());
+
+  g_test_timer_start();
+  girara_list_select_nth(copy, 50, compare_int);
+  g_test_minimized_result(g_test_timer_elapsed(), "select nth of 10^6 elements, n=50: %.3fs", g_test_timer_elapsed());
+
+  g_test_timer_start();
+  girara_list_sort(copy, compare_int);
+  g_test_minimized_result(g_test_timer_elapsed(), "full sort of 10^6 elements: %.3fs", g_test_timer_elapsed());
+
+  for (size_t idx = 0; idx != 50; ++idx) {
+    g_assert_cmpint((intptr_t)girara_list_nth(list, idx), ==, (intptr_t)girara_list_nth(copy, idx));
+  }
+
+  girara_list_free(copy);
+  girara_list_free(list);
+}
+
+typedef struct {
+  const char* name;
+  int value;
+} named_int_t;
+
+static int compare_named_int(const void* element, const void* key) {
+  return g_strcmp0(((const named_int_t*)element)->name, key);
+}
+
+static guint hash_named_int(const void* element) {
+  return g_str_hash(((const named_int_t*)element)->name);
+}
+
+static void test_datastructures_list_find_many(void) {
+  static const char* elements[] = {"e", "b", "d", "a", "b", "c"};
+  static const char* keys[]     = {"c", "x", "a", "b", "c", "0", "e"};
+
+  girara_list_t* list   = girara_list_new();
+  girara_list_t* sorted = girara_sorted_list_new(compare_string);
+  for (size_t idx = 0; idx != G_N_ELEMENTS(elements); ++idx) {
+    girara_list_append(list, (void*)elements[idx]);
+    girara_list_append(sorted, (void*)elements[idx]);
+  }
+
+  void* results[G_N_ELEMENTS(keys)];
+  g_assert_cmpuint(girara_list_find_many(list, compare_string, g_str_hash, NULL, (const void* const*)keys,
+                                         G_N_ELEMENTS(keys), results),
+                   ==, 5);
+  for (size_t idx = 0; idx != G_N_ELEMENTS(keys); ++idx) {
+    g_assert_true(results[idx] == girara_list_find(list, compare_string, keys[idx]));
+  }
+
+  /* sorted list, unsorted keys */
+  g_assert_cmpuint(girara_list_find_many(sorted, compare_string, NULL, NULL, (const void* const*)keys,
+                                         G_N_ELEMENTS(keys), results),
+                   ==, 5);
+  for (size_t idx = 0; idx != G_N_ELEMENTS(keys); ++idx) {
+    g_assert_true(results[idx] == girara_list_find(sorted, compare_string, keys[idx]));
+  }
+
+  /* sorted list, sorted keys */
+  static const char* sorted_keys[] = {"0", "a", "b", "b", "c", "d", "e", "f", "g", "h", "i", "j"};
+  void* sorted_results[G_N_ELEMENTS(sorted_keys)];
+  g_assert_cmpuint(girara_list_find_many(sorted, compare_string, NULL, NULL, (const void* const*)sorted_keys,
+                                         G_N_ELEMENTS(sorted_keys), sorted_results),
+                   ==, 6);
+  for (size_t idx = 0; idx != G_N_ELEMENTS(sorted_keys); ++idx) {
+    g_assert_true(sorted_results[idx] == girara_list_find(sorted, compare_string, sorted_keys[idx]));
+  }
+
+  /* element-vs-key compare function as used with girara_list_find */
+  static named_int_t named[]      = {{"b", 1}, {"a", 2}, {"b", 3}};
+  static const char* named_keys[] = {"b", "c", "a", "b"};
+  girara_list_t* named_list       = girara_list_new();
+  for (size_t idx = 0; idx != G_N_ELEMENTS(named); ++idx) {
+    girara_list_append(named_list, &named[idx]);
+  }
+
+  void* named_results[G_N_ELEMENTS(named_keys)];
+  g_assert_cmpuint(girara_list_find_many(named_list, compare_named_int, hash_named_int, g_str_hash,
+                                         (const void* const*)named_keys, G_N_ELEMENTS(named_keys), named_results),
+                   ==, 3);
+  for (size_t idx = 0; idx != G_N_ELEMENTS(named_keys); ++idx) {
+    g_assert_true(named_results[idx] == girara_list_find(named_list, compare_named_int, named_keys[idx]));
+  }
+  g_assert_cmpuint(girara_list_find_many(named_list, compare_named_int, NULL, NULL, (const void* const*)named_keys,
+                                         G_N_ELEMENTS(named_keys), named_results),
+                   ==, 3);
+  g_assert_true(named_results[0] == &named[0]);
+  g_assert_null(named_results[1]);
+  girara_list_free(named_list);
+
+  g_assert_cmpuint(girara_list_find_many(list, compare_string, NULL, NULL, NULL, 0, NULL), ==, 0);
+
+  girara_list_free(sorted);
+  girara_list_free(list);
+}
+
+static void test_datastructures_list_find_many_benchmark(void) {
+  girara_list_t* list = random_int_list(100000, G_MAXINT32);
+
+  const size_t n_keys = 2000;
+  const void** keys   = g_new(const void*, n_keys);
+  void** results      = g_new(void*, n_keys);
+  for (size_t idx = 0; idx != n_keys; ++idx) {
+    keys[idx] = girara_list_nth(list, (idx * 7919) % girara_list_size(list));
+  }
+
+  g_test_timer_start();
+  for (size_t idx = 0; idx != n_keys; ++idx) {
+    results[idx] = girara_list_find(list, compare_int, keys[idx]);
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "%zu lookups in 10^5 elements with find: %.3fs", n_keys,
+                          g_test_timer_elapsed());
+
+  g_test_timer_start();
+  g_assert_cmpuint(girara_list_find_many(list, compare_int, g_direct_hash, NULL, keys, n_keys, results), ==, n_keys);
+  g_test_minimized_result(g_test_timer_elapsed(), "%zu lookups in 10^5 elements with find_many: %.3fs", n_keys,
+                          g_test_timer_elapsed());
+
+  g_free(results);
+  g_free(keys);
+  girara_list_free(list);
+}
+
 static void node_free(void* data) {
   if (g_strcmp0((char*)data, "root") == 0) {
     g_assert_cmpuint(node_free_called, ==, 0);
@@ -321,6 +590,1083 @@ static void test_datastructures_node(void) {
   girara_node_free(root);
 }
 
+static girara_tree_node_t* build_wide_tree(size_t width, size_t height) {
+  girara_tree_node_t* root = girara_node_new(NULL);
+  g_assert_nonnull(root);
+
+  for (size_t i = 0; i != width; ++i) {
+    girara_tree_node_t* child = girara_node_append_data(root, (void*)i);
+    for (size_t j = 0; j != height; ++j) {
+      girara_node_append_data(child, (void*)j);
+    }
+  }
+
+  return root;
+}
+
+static void count_children(girara_tree_node_t* node, void* userdata) {
+  size_t* count = userdata;
+  g_assert_cmpuint((size_t)girara_node_get_data(node), ==, *count);
+  ++*count;
+}
+
+static void free_child(girara_tree_node_t* node, void* GIRARA_UNUSED(userdata)) {
+  girara_node_free(node);
+}
+
+static void test_datastructures_node_children(void) {
+  girara_tree_node_t* root = girara_node_new(NULL);
+  g_assert_null(girara_node_get_first_child(root));
+  g_assert_null(girara_node_get_last_child(root));
+  for (size_t i = 0; i != 10; ++i) {
+    girara_node_append_data(root, (void*)i);
+  }
+
+  size_t count = 0;
+  girara_node_foreach_child(root, count_children, &count);
+  g_assert_cmpuint(count, ==, 10);
+
+  count                     = 0;
+  girara_tree_node_t* child = girara_node_get_first_child(root);
+  for (; child != NULL; child = girara_node_get_next_sibling(child), ++count) {
+    g_assert_cmpuint((size_t)girara_node_get_data(child), ==, count);
+  }
+  g_assert_cmpuint(count, ==, 10);
+
+  child = girara_node_get_last_child(root);
+  for (; child != NULL; child = girara_node_get_previous_sibling(child)) {
+    g_assert_cmpuint((size_t)girara_node_get_data(child), ==, --count);
+  }
+  g_assert_cmpuint(count, ==, 0);
+
+  girara_node_foreach_child(root, free_child, NULL);
+  g_assert_cmpuint(girara_node_get_num_children(root), ==, 0);
+  g_assert_null(girara_node_get_first_child(root));
+  g_assert_null(girara_node_get_last_child(root));
+  girara_node_free(root);
+}
+
+static void test_datastructures_node_depth(void) {
+  girara_tree_node_t* root = girara_node_new("root");
+  g_assert_cmpuint(girara_node_get_depth(root), ==, 0);
+
+  girara_tree_node_t* child = girara_node_append_data(root, "child");
+  g_assert_cmpuint(girara_node_get_depth(child), ==, 1);
+  g_assert_true(girara_node_get_root(child) == root);
+
+  // build a detached subtree and attach it afterwards
+  girara_tree_node_t* subtree = girara_node_new("subtree");
+  girara_tree_node_t* leaf    = subtree;
+  for (unsigned int i = 0; i != 5; ++i) {
+    girara_node_append_data(subtree, "sibling");
+    leaf = girara_node_append_data(leaf, "leaf");
+  }
+  g_assert_cmpuint(girara_node_get_depth(leaf), ==, 5);
+  g_assert_true(girara_node_get_root(leaf) == subtree);
+
+  girara_node_append(child, subtree);
+  g_assert_cmpuint(girara_node_get_num_children(child), ==, 1);
+  g_assert_cmpuint(girara_node_get_num_children(subtree), ==, 6);
+  g_assert_cmpuint(girara_node_get_depth(subtree), ==, 2);
+  g_assert_cmpuint(girara_node_get_depth(leaf), ==, 7);
+  g_assert_true(girara_node_get_root(leaf) == root);
+  g_assert_true(girara_node_get_root(girara_node_get_last_child(subtree)) == root);
+
+  girara_node_free(subtree);
+  g_assert_cmpuint(girara_node_get_num_children(child), ==, 0);
+  girara_node_free(root);
+}
+
+static void test_datastructures_node_free_deep(void) {
+  // freeing must not recurse once per level
+  girara_tree_node_t* root = girara_node_new(NULL);
+  girara_tree_node_t* leaf = root;
+  for (size_t i = 0; i != 1000000; ++i) {
+    leaf = girara_node_append_data(leaf, NULL);
+  }
+  g_assert_cmpuint(girara_node_get_depth(leaf), ==, 1000000);
+  g_assert_true(girara_node_get_root(leaf) == root);
+  girara_node_free(root);
+}
+
+static gint parallel_free_called = 0;
+
+static void parallel_node_free(void* GIRARA_UNUSED(data)) {
+  g_atomic_int_inc(&parallel_free_called);
+}
+
+static void test_datastructures_node_free_parallel(void) {
+  g_autoptr(girara_tree_pool_t) pool = girara_tree_pool_new();
+  for (unsigned int round = 0; round != 2; ++round) {
+    girara_tree_node_t* root = girara_node_new_in_pool(round == 0 ? NULL : pool, NULL);
+    girara_node_set_free_function(root, parallel_node_free);
+    for (size_t i = 0; i != 100; ++i) {
+      girara_tree_node_t* child = girara_node_append_data(root, NULL);
+      for (size_t j = 0; j != 100; ++j) {
+        girara_node_append_data(child, NULL);
+      }
+    }
+
+    // a long chain
+    girara_tree_node_t* leaf = root;
+    for (size_t i = 0; i != 1000; ++i) {
+      leaf = girara_node_append_data(leaf, NULL);
+    }
+
+    parallel_free_called = 0;
+    girara_node_free_parallel(root, 4);
+    g_assert_cmpint(g_atomic_int_get(&parallel_free_called), ==, 1 + 100 + 100 * 100 + 1000);
+  }
+
+  // subtrees are unlinked from their parent
+  girara_tree_node_t* root  = girara_node_new(NULL);
+  girara_tree_node_t* child = girara_node_append_data(root, NULL);
+  girara_node_append_data(child, NULL);
+  girara_node_append_data(child, NULL);
+  girara_node_free_parallel(child, 0);
+  g_assert_cmpuint(girara_node_get_num_children(root), ==, 0);
+  g_assert_null(girara_node_get_first_child(root));
+  girara_node_free_parallel(root, 1);
+}
+
+/*
+ * Test tree:
+ *        a
+ *      / | \
+ *     b  e  f
+ *    / \     \
+ *   c   d     g
+ */
+static girara_tree_node_t* build_test_tree(void) {
+  girara_tree_node_t* a = girara_node_new("a");
+  girara_tree_node_t* b = girara_node_append_data(a, "b");
+  girara_node_append_data(b, "c");
+  girara_node_append_data(b, "d");
+  girara_node_append_data(a, "e");
+  girara_tree_node_t* f = girara_node_append_data(a, "f");
+  girara_node_append_data(f, "g");
+
+  return a;
+}
+
+static char* iterate_tree(girara_tree_node_t* root, girara_node_traverse_order_t order, const char* skip) {
+  GString* result = g_string_new(NULL);
+
+  g_auto(girara_node_iter_t) iter;
+  girara_node_iter_init(&iter, root, order);
+  girara_tree_node_t* node = NULL;
+  while ((node = girara_node_iter_next(&iter)) != NULL) {
+    const char* data = girara_node_get_data(node);
+    g_string_append(result, data);
+    if (skip != NULL && strchr(skip, data[0]) != NULL) {
+      girara_node_iter_skip_children(&iter);
+    }
+  }
+  g_assert_null(girara_node_iter_next(&iter));
+
+  return g_string_free(result, FALSE);
+}
+
+static girara_node_traverse_result_t traverse_until_e(girara_tree_node_t* node, void* userdata) {
+  GString* result  = userdata;
+  const char* data = girara_node_get_data(node);
+  g_string_append(result, data);
+
+  if (g_strcmp0(data, "b") == 0) {
+    return GIRARA_NODE_TRAVERSE_SKIP_CHILDREN;
+  } else if (g_strcmp0(data, "e") == 0) {
+    return GIRARA_NODE_TRAVERSE_STOP;
+  }
+  return GIRARA_NODE_TRAVERSE_CONTINUE;
+}
+
+static void test_datastructures_node_traverse(void) {
+  girara_tree_node_t* root = build_test_tree();
+
+  static const struct {
+    girara_node_traverse_order_t order;
+    const char* skip;
+    const char* expected;
+  } cases[] = {
+      {GIRARA_NODE_PRE_ORDER, NULL, "abcdefg"},
+      {GIRARA_NODE_POST_ORDER, NULL, "cdbegfa"},
+      {GIRARA_NODE_LEVEL_ORDER, NULL, "abefcdg"},
+      {GIRARA_NODE_PRE_ORDER, "b", "abefg"},
+      {GIRARA_NODE_LEVEL_ORDER, "b", "abefg"},
+      {GIRARA_NODE_PRE_ORDER, "a", "a"},
+      {GIRARA_NODE_LEVEL_ORDER, "a", "a"},
+      {GIRARA_NODE_POST_ORDER, "abf", "cdbegfa"},
+      {GIRARA_NODE_LEVEL_ORDER, "f", "abefcd"},
+  };
+
+  for (size_t idx = 0; idx != G_N_ELEMENTS(cases); ++idx) {
+    g_autofree char* result = iterate_tree(root, cases[idx].order, cases[idx].skip);
+    g_assert_cmpstr(result, ==, cases[idx].expected);
+  }
+
+  // subtrees
+  girara_tree_node_t* b = girara_node_get_first_child(root);
+  g_autofree char* pre  = iterate_tree(b, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(pre, ==, "bcd");
+  g_autofree char* post = iterate_tree(b, GIRARA_NODE_POST_ORDER, NULL);
+  g_assert_cmpstr(post, ==, "cdb");
+  g_autofree char* level = iterate_tree(girara_node_get_last_child(root), GIRARA_NODE_LEVEL_ORDER, NULL);
+  g_assert_cmpstr(level, ==, "fg");
+
+  // callbacks
+  GString* result = g_string_new(NULL);
+  g_assert_false(girara_node_traverse(root, GIRARA_NODE_PRE_ORDER, traverse_until_e, result));
+  g_assert_cmpstr(result->str, ==, "abe");
+  g_string_truncate(result, 0);
+  g_assert_false(girara_node_traverse(root, GIRARA_NODE_LEVEL_ORDER, traverse_until_e, result));
+  g_assert_cmpstr(result->str, ==, "abe");
+  g_string_truncate(result, 0);
+  g_assert_true(girara_node_traverse(b, GIRARA_NODE_POST_ORDER, traverse_until_e, result));
+  g_assert_cmpstr(result->str, ==, "cdb");
+  g_string_free(result, TRUE);
+
+  girara_node_free(root);
+}
+
+static void test_datastructures_node_find_child(void) {
+  girara_tree_node_t* root = girara_node_new(g_strdup("root"));
+  girara_node_set_free_function(root, g_free);
+  girara_node_set_key_function(root, g_str_hash, g_str_equal);
+
+  // small fanout
+  girara_tree_node_t* a = girara_node_append_data(root, g_strdup("a"));
+  girara_tree_node_t* b = girara_node_append_data(a, g_strdup("b"));
+  g_assert_true(girara_node_find_child(root, "a") == a);
+  g_assert_null(girara_node_find_child(root, "b"));
+
+  const char* path[] = {"a", "b"};
+  g_assert_true(girara_node_find_path(root, (const void* const*)path, 2) == b);
+  g_assert_true(girara_node_find_path(root, (const void* const*)path, 0) == root);
+  const char* missing[] = {"a", "c"};
+  g_assert_null(girara_node_find_path(root, (const void* const*)missing, 2));
+
+  // large fanout with duplicates, the first child wins
+  for (size_t idx = 0; idx != 100; ++idx) {
+    girara_node_append_data(a, g_strdup_printf("%zu", idx % 50));
+  }
+  girara_tree_node_t* first = girara_node_find_child(a, "7");
+  g_assert_nonnull(first);
+  g_assert_true(girara_node_get_previous_sibling(first) == girara_node_find_child(a, "6"));
+  g_assert_true(girara_node_find_child(a, "b") == b);
+  g_assert_null(girara_node_find_child(a, "50"));
+
+  // removing and changing children updates the index
+  girara_tree_node_t* second = girara_node_find_child(a, "8");
+  girara_node_free(first);
+  g_assert_cmpstr(girara_node_get_data(girara_node_find_child(a, "7")), ==, "7");
+  g_assert_true(girara_node_find_child(a, "7") != first);
+  girara_node_set_data(second, g_strdup("new"));
+  g_assert_true(girara_node_find_child(a, "new") == second);
+  g_assert_true(girara_node_find_child(a, "8") != second);
+  girara_tree_node_t* c = girara_node_append_data(a, g_strdup("c"));
+  g_assert_true(girara_node_find_child(a, "c") == c);
+
+  // pointer comparison without key functions
+  girara_node_set_key_function(root, NULL, NULL);
+  g_assert_null(girara_node_find_child(a, "c"));
+  g_assert_true(girara_node_find_child(a, girara_node_get_data(c)) == c);
+
+  girara_node_free(root);
+}
+
+static void append_data_to_string(void* data, void* userdata) {
+  g_string_append(userdata, data);
+}
+
+static void test_datastructures_flat_tree(void) {
+  girara_tree_node_t* root = build_test_tree();
+  girara_tree_node_t* b    = girara_node_get_first_child(root);
+
+  // subtree of a larger tree
+  g_autoptr(girara_flat_tree_t) sub = girara_node_freeze(b);
+  g_assert_nonnull(sub);
+  g_assert_cmpuint(girara_flat_tree_size(sub), ==, 3);
+  g_assert_cmpuint(girara_flat_tree_get_parent(sub, 0), ==, GIRARA_FLAT_TREE_NONE);
+  g_assert_cmpuint(girara_flat_tree_get_parent(sub, 2), ==, 0);
+
+  g_autoptr(girara_flat_tree_t) tree = girara_node_freeze(root);
+  g_assert_nonnull(tree);
+  girara_node_free(root);
+
+  g_assert_cmpuint(girara_flat_tree_size(tree), ==, 7);
+  GString* result = g_string_new(NULL);
+  girara_flat_tree_foreach(tree, append_data_to_string, result);
+  g_assert_cmpstr(result->str, ==, "abcdefg");
+  g_string_free(result, TRUE);
+
+  // a(b(c,d),e,f(g)) is stored as a=0, b=1, c=2, d=3, e=4, f=5, g=6
+  static const struct {
+    size_t parent;
+    size_t first_child;
+    size_t next_sibling;
+    size_t subtree_size;
+  } expected[] = {
+      {GIRARA_FLAT_TREE_NONE, 1, GIRARA_FLAT_TREE_NONE, 7},
+      {0, 2, 4, 3},
+      {1, GIRARA_FLAT_TREE_NONE, 3, 1},
+      {1, GIRARA_FLAT_TREE_NONE, GIRARA_FLAT_TREE_NONE, 1},
+      {0, GIRARA_FLAT_TREE_NONE, 5, 1},
+      {0, 6, GIRARA_FLAT_TREE_NONE, 2},
+      {5, GIRARA_FLAT_TREE_NONE, GIRARA_FLAT_TREE_NONE, 1},
+  };
+  for (size_t idx = 0; idx != G_N_ELEMENTS(expected); ++idx) {
+    g_assert_cmpint(((const char*)girara_flat_tree_get_data(tree, idx))[0], ==, 'a' + idx);
+    g_assert_cmpuint(girara_flat_tree_get_parent(tree, idx), ==, expected[idx].parent);
+    g_assert_cmpuint(girara_flat_tree_get_first_child(tree, idx), ==, expected[idx].first_child);
+    g_assert_cmpuint(girara_flat_tree_get_next_sibling(tree, idx), ==, expected[idx].next_sibling);
+    g_assert_cmpuint(girara_flat_tree_get_subtree_size(tree, idx), ==, expected[idx].subtree_size);
+    g_assert_cmpuint(girara_flat_tree_skip_subtree(tree, idx), ==, idx + expected[idx].subtree_size);
+  }
+
+  // ownership of the data moves to the flat tree
+  girara_tree_node_t* owned = girara_node_new(g_strdup("x"));
+  girara_node_set_free_function(owned, g_free);
+  girara_node_append_data(owned, g_strdup("y"));
+  girara_flat_tree_t* owning = girara_node_freeze(owned);
+  girara_node_free(owned);
+  g_assert_cmpstr(girara_flat_tree_get_data(owning, 1), ==, "y");
+  girara_flat_tree_free(owning);
+}
+
+static bool write_string(const void* data, GByteArray* buffer, void* GIRARA_UNUSED(userdata)) {
+  g_byte_array_append(buffer, data, strlen(data) + 1);
+  return true;
+}
+
+static bool write_fails(const void* GIRARA_UNUSED(data), GByteArray* GIRARA_UNUSED(buffer),
+                        void* GIRARA_UNUSED(userdata)) {
+  return false;
+}
+
+static void* read_string(const void* bytes, size_t length, void* GIRARA_UNUSED(userdata)) {
+  return g_strndup(bytes, length);
+}
+
+static char* serialize_tree(girara_tree_node_t* root, girara_node_data_writer_t writer, void* userdata) {
+  g_autoptr(GError) error = NULL;
+  char* path              = NULL;
+  const int fd            = g_file_open_tmp("girara-tree-XXXXXX", &path, &error);
+  g_assert_no_error(error);
+  g_close(fd, NULL);
+
+  g_autoptr(GFile) file               = g_file_new_for_path(path);
+  g_autoptr(GFileOutputStream) stream = g_file_replace(file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, &error);
+  g_assert_no_error(error);
+  g_assert_true(girara_node_serialize(root, G_OUTPUT_STREAM(stream), writer, userdata, &error));
+  g_assert_no_error(error);
+  g_assert_true(g_output_stream_close(G_OUTPUT_STREAM(stream), NULL, &error));
+  g_assert_no_error(error);
+
+  return path;
+}
+
+static void test_datastructures_node_serialize(void) {
+  girara_tree_node_t* root = build_test_tree();
+  g_autofree char* path    = serialize_tree(root, write_string, NULL);
+
+  // referencing the mapped data
+  g_autoptr(GError) error            = NULL;
+  g_autoptr(girara_flat_tree_t) tree = girara_flat_tree_load(path, NULL, NULL, NULL, &error);
+  g_assert_no_error(error);
+  g_assert_nonnull(tree);
+  g_assert_cmpuint(girara_flat_tree_size(tree), ==, 7);
+  GString* result = g_string_new(NULL);
+  girara_flat_tree_foreach(tree, append_data_to_string, result);
+  g_assert_cmpstr(result->str, ==, "abcdefg");
+  g_string_free(result, TRUE);
+  g_assert_cmpuint(girara_flat_tree_get_parent(tree, 6), ==, 5);
+  g_assert_cmpuint(girara_flat_tree_get_next_sibling(tree, 1), ==, 4);
+
+  // copying the data
+  g_autoptr(girara_flat_tree_t) copy = girara_flat_tree_load(path, read_string, NULL, g_free, &error);
+  g_assert_no_error(error);
+  g_assert_cmpstr(girara_flat_tree_get_data(copy, 3), ==, "d");
+  g_assert_cmpuint(girara_flat_tree_get_subtree_size(copy, 1), ==, 3);
+
+  // corrupted input
+  char* contents = NULL;
+  size_t length  = 0;
+  g_assert_true(g_file_get_contents(path, &contents, &length, &error));
+  g_assert_no_error(error);
+
+  static const struct {
+    size_t offset;
+    size_t length;
+    int code;
+  } corruptions[] = {
+      {0, 0, GIRARA_TREE_ERROR_INVALID_FORMAT},   // magic
+      {8, 0, GIRARA_TREE_ERROR_VERSION},          // version
+      {64, 0, GIRARA_TREE_ERROR_CHECKSUM},        // node table
+      {0, 63, GIRARA_TREE_ERROR_INVALID_FORMAT},  // truncated header
+      {0, 100, GIRARA_TREE_ERROR_INVALID_FORMAT}, // truncated table
+  };
+  for (size_t idx = 0; idx != G_N_ELEMENTS(corruptions); ++idx) {
+    char* corrupted = g_memdup2(contents, length);
+    if (corruptions[idx].length == 0) {
+      ++corrupted[corruptions[idx].offset];
+    }
+    const size_t size       = corruptions[idx].length != 0 ? corruptions[idx].length : length;
+    g_autoptr(GBytes) bytes = g_bytes_new_take(corrupted, size);
+    g_assert_null(girara_flat_tree_load_bytes(bytes, NULL, NULL, NULL, &error));
+    g_assert_error(error, GIRARA_TREE_ERROR, corruptions[idx].code);
+    g_clear_error(&error);
+  }
+
+  // g is not a child of b, which is complete once c and d were visited
+  const guint64 parent = GUINT64_TO_LE(1);
+  memcpy(contents + 64 + 6 * 24, &parent, sizeof(parent));
+  GChecksum* checksum = g_checksum_new(G_CHECKSUM_SHA256);
+  g_checksum_update(checksum, (const guchar*)contents + 64, length - 64);
+  gsize digest_length = 32;
+  g_checksum_get_digest(checksum, (guint8*)contents + 32, &digest_length);
+  g_checksum_free(checksum);
+  g_autoptr(GBytes) reparented = g_bytes_new_take(contents, length);
+  g_assert_null(girara_flat_tree_load_bytes(reparented, NULL, NULL, NULL, &error));
+  g_assert_error(error, GIRARA_TREE_ERROR, GIRARA_TREE_ERROR_INVALID_FORMAT);
+  g_clear_error(&error);
+  g_unlink(path);
+
+  // failing writer
+  g_autoptr(GFile) file               = g_file_new_for_path(path);
+  g_autoptr(GFileOutputStream) stream = g_file_replace(file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, &error);
+  g_assert_no_error(error);
+  g_assert_false(girara_node_serialize(root, G_OUTPUT_STREAM(stream), write_fails, NULL, &error));
+  g_assert_error(error, GIRARA_TREE_ERROR, GIRARA_TREE_ERROR_DATA);
+  g_output_stream_close(G_OUTPUT_STREAM(stream), NULL, NULL);
+  g_unlink(path);
+
+  girara_node_free(root);
+}
+
+static void test_datastructures_node_restructure(void) {
+  girara_tree_node_t* root = build_test_tree();
+  girara_tree_node_t* b    = girara_node_get_first_child(root);
+  girara_tree_node_t* e    = girara_node_get_next_sibling(b);
+  girara_tree_node_t* f    = girara_node_get_last_child(root);
+  girara_tree_node_t* g    = girara_node_get_first_child(f);
+
+  // detach and reinsert in all positions
+  girara_node_unlink(e);
+  g_assert_null(girara_node_get_parent(e));
+  g_assert_true(girara_node_get_root(e) == e);
+  g_assert_cmpuint(girara_node_get_depth(e), ==, 0);
+  g_assert_cmpuint(girara_node_get_num_children(root), ==, 2);
+  g_autofree char* unlinked = iterate_tree(root, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(unlinked, ==, "abcdfg");
+
+  girara_node_prepend(root, e);
+  g_autofree char* prepended = iterate_tree(root, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(prepended, ==, "aebcdfg");
+
+  girara_node_unlink(e);
+  girara_node_insert_after(g, e);
+  g_assert_cmpuint(girara_node_get_depth(e), ==, 2);
+  g_autofree char* inserted_after = iterate_tree(root, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(inserted_after, ==, "abcdfge");
+
+  girara_node_unlink(e);
+  girara_node_insert_before(g, e);
+  g_assert_true(girara_node_get_first_child(f) == e);
+  g_assert_cmpuint(girara_node_get_num_children(f), ==, 2);
+  g_autofree char* inserted_before = iterate_tree(root, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(inserted_before, ==, "abcdfeg");
+
+  // move subtrees around
+  girara_node_move(f, b, 1);
+  g_assert_cmpuint(girara_node_get_depth(g), ==, 3);
+  g_assert_cmpuint(girara_node_get_num_children(root), ==, 1);
+  g_autofree char* moved = iterate_tree(root, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(moved, ==, "abcfegd");
+
+  girara_node_move(f, root, 0);
+  g_autofree char* moved_first = iterate_tree(root, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(moved_first, ==, "afegbcd");
+
+  girara_node_move(f, root, 100);
+  g_autofree char* moved_last = iterate_tree(root, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(moved_last, ==, "abcdfeg");
+  g_assert_cmpuint(girara_node_get_depth(g), ==, 2);
+
+  // cycles are rejected
+  g_test_expect_message(NULL, G_LOG_LEVEL_CRITICAL, "*assertion*failed*");
+  girara_node_move(b, girara_node_get_first_child(b), 0);
+  g_test_expect_message(NULL, G_LOG_LEVEL_CRITICAL, "*assertion*failed*");
+  girara_node_move(root, g, 0);
+  g_test_expect_message(NULL, G_LOG_LEVEL_CRITICAL, "*assertion*failed*");
+  girara_node_append(g, root);
+  g_test_assert_expected_messages();
+  g_autofree char* unchanged = iterate_tree(root, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(unchanged, ==, "abcdfeg");
+
+  // the key index follows the changes
+  girara_tree_node_t* keyed = girara_node_new(g_strdup("keyed"));
+  girara_node_set_free_function(keyed, g_free);
+  girara_node_set_key_function(keyed, g_str_hash, g_str_equal);
+  for (size_t idx = 0; idx != 32; ++idx) {
+    girara_node_append_data(keyed, g_strdup_printf("%zu", idx));
+  }
+  girara_tree_node_t* twelve = girara_node_find_child(keyed, "12");
+  girara_tree_node_t* other  = girara_node_new(g_strdup("12"));
+  girara_node_set_free_function(other, g_free);
+  girara_node_prepend(keyed, other);
+  g_assert_true(girara_node_find_child(keyed, "12") == other);
+  girara_node_unlink(other);
+  g_assert_true(girara_node_find_child(keyed, "12") == twelve);
+  girara_node_free(other);
+
+  girara_tree_node_t* five = girara_node_find_child(keyed, "5");
+  girara_node_unlink(five);
+  g_assert_null(girara_node_find_child(keyed, "5"));
+  girara_node_append_data(five, g_strdup("child"));
+  g_assert_nonnull(girara_node_find_child(five, "child"));
+  girara_node_free(five);
+
+  girara_node_free(keyed);
+  girara_node_free(root);
+}
+
+static void test_datastructures_node_build(void) {
+  // a(b(c,d),e,f(g)) with the children of the root listed before their children
+  static const char* const data[]    = {"a", "b", "e", "f", "c", "d", "g"};
+  static const size_t parent_index[] = {GIRARA_FLAT_TREE_NONE, 0, 0, 0, 1, 1, 3};
+
+  girara_tree_node_t* root = girara_node_build((void* const*)data, parent_index, G_N_ELEMENTS(data));
+  g_assert_nonnull(root);
+  g_autofree char* pre = iterate_tree(root, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(pre, ==, "abcdefg");
+  g_assert_cmpuint(girara_node_get_num_children(root), ==, 3);
+  girara_tree_node_t* g = girara_node_get_first_child(girara_node_get_last_child(root));
+  g_assert_cmpuint(girara_node_get_depth(g), ==, 2);
+  g_assert_true(girara_node_get_root(g) == root);
+
+  // the built tree can be modified like any other tree
+  girara_node_append_data(g, "h");
+  girara_node_free(girara_node_get_first_child(root));
+
+  void** flat_data     = NULL;
+  size_t* flat_parents = NULL;
+  const size_t size    = girara_node_flatten(root, &flat_data, &flat_parents);
+  g_assert_cmpuint(size, ==, 5);
+  static const char* const expected_data[]    = {"a", "e", "f", "g", "h"};
+  static const size_t expected_parent_index[] = {GIRARA_FLAT_TREE_NONE, 0, 0, 2, 3};
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_assert_cmpstr(flat_data[idx], ==, expected_data[idx]);
+    g_assert_cmpuint(flat_parents[idx], ==, expected_parent_index[idx]);
+  }
+
+  // round trip
+  girara_tree_node_t* copy = girara_node_build(flat_data, flat_parents, size);
+  g_autofree char* copied  = iterate_tree(copy, GIRARA_NODE_PRE_ORDER, NULL);
+  g_assert_cmpstr(copied, ==, "aefgh");
+  girara_node_free(copy);
+  g_free(flat_data);
+  g_free(flat_parents);
+  girara_node_free(root);
+
+  // owned data
+  void* owned[]             = {g_strdup("x"), g_strdup("y"), g_strdup("z")};
+  const size_t owned_tree[] = {GIRARA_FLAT_TREE_NONE, 0, 1};
+  root                      = girara_node_build_with_free(owned, owned_tree, G_N_ELEMENTS(owned), g_free);
+  g_assert_cmpuint(girara_node_get_depth(girara_node_get_first_child(girara_node_get_first_child(root))), ==, 2);
+  girara_node_free(root);
+
+  // invalid input
+  static const size_t forward[] = {GIRARA_FLAT_TREE_NONE, 2, 0};
+  g_test_expect_message(NULL, G_LOG_LEVEL_CRITICAL, "*assertion*failed*");
+  g_assert_null(girara_node_build((void* const*)data, forward, G_N_ELEMENTS(forward)));
+  static const size_t no_root[] = {0, 0};
+  g_test_expect_message(NULL, G_LOG_LEVEL_CRITICAL, "*assertion*failed*");
+  g_assert_null(girara_node_build((void* const*)data, no_root, G_N_ELEMENTS(no_root)));
+  g_test_assert_expected_messages();
+}
+
+static size_t count_nodes(girara_tree_node_t* node) {
+  size_t count              = 1;
+  girara_tree_node_t* child = girara_node_get_first_child(node);
+  for (; child != NULL; child = girara_node_get_next_sibling(child)) {
+    count += count_nodes(child);
+  }
+
+  return count;
+}
+
+static size_t count_nodes_list(girara_tree_node_t* node) {
+  size_t count                      = 1;
+  g_autoptr(girara_list_t) children = girara_node_get_children(node);
+  for (size_t idx = 0; idx != girara_list_size(children); ++idx) {
+    count += count_nodes_list(girara_list_nth(children, idx));
+  }
+
+  return count;
+}
+
+static unsigned int pool_free_called = 0;
+
+static void pool_node_free(void* GIRARA_UNUSED(data)) {
+  ++pool_free_called;
+}
+
+static void test_datastructures_node_pool(void) {
+  girara_tree_pool_t* pool = girara_tree_pool_new();
+  g_assert_nonnull(pool);
+
+  for (unsigned int round = 0; round != 2; ++round) {
+    pool_free_called         = 0;
+    girara_tree_node_t* root = girara_node_new_in_pool(pool, "root");
+    g_assert_nonnull(root);
+    girara_node_set_free_function(root, pool_node_free);
+    for (unsigned int i = 0; i != 100; ++i) {
+      girara_tree_node_t* child = girara_node_append_data(root, "child");
+      for (unsigned int j = 0; j != 10; ++j) {
+        girara_node_append_data(child, "grandchild");
+      }
+      g_assert_cmpuint(girara_node_get_num_children(child), ==, 10);
+    }
+    g_assert_cmpuint(girara_node_get_num_children(root), ==, 100);
+
+    // freeing a subtree recycles its nodes
+    girara_list_t* children = girara_node_get_children(root);
+    girara_node_free(girara_list_nth(children, 0));
+    girara_list_free(children);
+    g_assert_cmpuint(pool_free_called, ==, 11);
+    g_assert_cmpuint(girara_node_get_num_children(root), ==, 99);
+    girara_node_append_data(root, "child");
+
+    girara_node_free(root);
+    g_assert_cmpuint(pool_free_called, ==, 11 + 1 + 100 + 99 * 10);
+  }
+
+  // nodes outlive the pool
+  girara_tree_node_t* root = girara_node_new_in_pool(pool, "root");
+  girara_node_append_data(root, "child");
+  girara_tree_pool_free(pool);
+  g_assert_cmpstr(girara_node_get_data(girara_node_get_root(root)), ==, "root");
+  girara_node_free(root);
+}
+
+static girara_tree_node_t* build_wide_tree_in_pool(girara_tree_pool_t* pool, size_t width, size_t height) {
+  girara_tree_node_t* root = girara_node_new_in_pool(pool, NULL);
+  g_assert_nonnull(root);
+
+  for (size_t i = 0; i != width; ++i) {
+    girara_tree_node_t* child = girara_node_append_data(root, (void*)i);
+    for (size_t j = 0; j != height; ++j) {
+      girara_node_append_data(child, (void*)j);
+    }
+  }
+
+  return root;
+}
+
+static void test_datastructures_node_pool_benchmark(void) {
+  g_autoptr(girara_tree_pool_t) pool = girara_tree_pool_new();
+
+  g_test_timer_start();
+  girara_tree_node_t* root = build_wide_tree_in_pool(pool, 1000, 1000);
+  g_test_minimized_result(g_test_timer_elapsed(), "building a pooled tree with 10^6 nodes: %.3fs",
+                          g_test_timer_elapsed());
+
+  g_test_timer_start();
+  girara_node_free(root);
+  g_test_minimized_result(g_test_timer_elapsed(), "freeing a pooled tree with 10^6 nodes: %.3fs",
+                          g_test_timer_elapsed());
+}
+
+static void test_datastructures_node_free_benchmark(void) {
+  for (unsigned int n_threads = 1; n_threads <= 8; n_threads *= 2) {
+    girara_tree_node_t* root = build_wide_tree(1000, 1000);
+    girara_node_set_free_function(root, parallel_node_free);
+
+    g_test_timer_start();
+    girara_node_free_parallel(root, n_threads);
+    g_test_minimized_result(g_test_timer_elapsed(), "freeing a tree with 10^6 nodes using %u threads: %.3fs",
+                            n_threads, g_test_timer_elapsed());
+  }
+}
+
+static void test_datastructures_node_find_child_benchmark(void) {
+  girara_tree_node_t* root = girara_node_new(NULL);
+  girara_node_set_free_function(root, g_free);
+  girara_node_set_key_function(root, g_str_hash, g_str_equal);
+
+  char** keys = g_new0(char*, 1001);
+  for (size_t idx = 0; idx != 1000; ++idx) {
+    girara_node_append_data(root, g_strdup_printf("key-%zu", idx));
+    keys[idx] = g_strdup_printf("key-%zu", idx);
+  }
+
+  g_test_timer_start();
+  for (size_t round = 0; round != 10; ++round) {
+    for (size_t idx = 0; idx != 1000; ++idx) {
+      girara_list_t* children = girara_node_get_children(root);
+      girara_tree_node_t* found = NULL;
+      for (size_t child = 0; child != girara_list_size(children) && found == NULL; ++child) {
+        girara_tree_node_t* node = girara_list_nth(children, child);
+        if (g_str_equal(girara_node_get_data(node), keys[idx])) {
+          found = node;
+        }
+      }
+      g_assert_nonnull(found);
+      girara_list_free(children);
+    }
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "10^4 lookups among 1000 children using children lists: %.3fs",
+                          g_test_timer_elapsed());
+
+  g_test_timer_start();
+  for (size_t round = 0; round != 10; ++round) {
+    for (size_t idx = 0; idx != 1000; ++idx) {
+      g_assert_nonnull(girara_node_find_child(root, keys[idx]));
+    }
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "10^4 lookups among 1000 children using the index: %.3fs",
+                          g_test_timer_elapsed());
+
+  g_strfreev(keys);
+  girara_node_free(root);
+}
+
+static void sum_data(void* data, void* userdata) {
+  size_t* sum = userdata;
+  *sum += (size_t)data;
+}
+
+static void test_datastructures_flat_tree_benchmark(void) {
+  girara_tree_node_t* root = build_wide_tree(1000, 1000);
+
+  g_test_timer_start();
+  size_t sum = 0;
+  {
+    g_auto(girara_node_iter_t) iter;
+    girara_node_iter_init(&iter, root, GIRARA_NODE_PRE_ORDER);
+    girara_tree_node_t* node = NULL;
+    while ((node = girara_node_iter_next(&iter)) != NULL) {
+      sum += (size_t)girara_node_get_data(node);
+    }
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "scanning a tree with 10^6 nodes: %.3fs", g_test_timer_elapsed());
+
+  g_test_timer_start();
+  g_autoptr(girara_flat_tree_t) tree = girara_node_freeze(root);
+  g_test_minimized_result(g_test_timer_elapsed(), "freezing a tree with 10^6 nodes: %.3fs", g_test_timer_elapsed());
+  girara_node_free(root);
+
+  g_test_timer_start();
+  size_t flat_sum = 0;
+  girara_flat_tree_foreach(tree, sum_data, &flat_sum);
+  g_test_minimized_result(g_test_timer_elapsed(), "scanning a flat tree with 10^6 nodes: %.3fs",
+                          g_test_timer_elapsed());
+  g_assert_cmpuint(sum, ==, flat_sum);
+
+  g_test_timer_start();
+  size_t children = 0;
+  size_t child    = girara_flat_tree_get_first_child(tree, 0);
+  while (child != GIRARA_FLAT_TREE_NONE) {
+    child = girara_flat_tree_get_next_sibling(tree, child);
+    ++children;
+  }
+  g_assert_cmpuint(children, ==, 1000);
+  g_test_minimized_result(g_test_timer_elapsed(), "walking the children of a flat tree: %.3fs", g_test_timer_elapsed());
+}
+
+static bool write_size(const void* data, GByteArray* buffer, void* GIRARA_UNUSED(userdata)) {
+  const size_t value = (size_t)data;
+  g_byte_array_append(buffer, (const guint8*)&value, sizeof(value));
+  return true;
+}
+
+static void* read_size(const void* bytes, size_t GIRARA_UNUSED(length), void* GIRARA_UNUSED(userdata)) {
+  return (void*)*(const size_t*)bytes;
+}
+
+static void test_datastructures_node_serialize_benchmark(void) {
+  g_test_timer_start();
+  girara_tree_node_t* root = build_wide_tree(1000, 1000);
+  g_test_minimized_result(g_test_timer_elapsed(), "building a tree with 10^6 nodes: %.3fs", g_test_timer_elapsed());
+
+  g_test_timer_start();
+  g_autofree char* path = serialize_tree(root, write_size, NULL);
+  g_test_minimized_result(g_test_timer_elapsed(), "serializing a tree with 10^6 nodes: %.3fs", g_test_timer_elapsed());
+  girara_node_free(root);
+
+  g_autoptr(GError) error = NULL;
+  g_test_timer_start();
+  girara_flat_tree_t* tree = girara_flat_tree_load(path, read_size, NULL, NULL, &error);
+  g_test_minimized_result(g_test_timer_elapsed(), "loading a tree with 10^6 nodes: %.3fs", g_test_timer_elapsed());
+  g_assert_no_error(error);
+  g_assert_cmpuint(girara_flat_tree_size(tree), ==, 1001001);
+  girara_flat_tree_free(tree);
+
+  g_unlink(path);
+}
+
+static void test_datastructures_node_build_benchmark(void) {
+  void** data          = g_try_malloc_n(1001001, sizeof(void*));
+  size_t* parent_index = g_try_malloc_n(1001001, sizeof(size_t));
+  g_assert_nonnull(data);
+  g_assert_nonnull(parent_index);
+
+  // the same shape as build_wide_tree(1000, 1000)
+  data[0]         = NULL;
+  parent_index[0] = GIRARA_FLAT_TREE_NONE;
+  size_t size     = 1;
+  for (size_t i = 0; i != 1000; ++i) {
+    const size_t child  = size++;
+    data[child]         = (void*)i;
+    parent_index[child] = 0;
+    for (size_t j = 0; j != 1000; ++j) {
+      data[size]         = (void*)j;
+      parent_index[size] = child;
+      ++size;
+    }
+  }
+
+  g_test_timer_start();
+  girara_tree_node_t* root = build_wide_tree(1000, 1000);
+  g_test_minimized_result(g_test_timer_elapsed(), "building a tree with 10^6 nodes by appending: %.3fs",
+                          g_test_timer_elapsed());
+  girara_node_free(root);
+
+  g_test_timer_start();
+  root = girara_node_build(data, parent_index, size);
+  g_test_minimized_result(g_test_timer_elapsed(), "building a tree with 10^6 nodes in bulk: %.3fs",
+                          g_test_timer_elapsed());
+  g_assert_cmpuint(count_nodes(root), ==, size);
+  g_free(data);
+  g_free(parent_index);
+
+  g_test_timer_start();
+  size = girara_node_flatten(root, &data, &parent_index);
+  g_test_minimized_result(g_test_timer_elapsed(), "flattening a tree with 10^6 nodes: %.3fs", g_test_timer_elapsed());
+  g_assert_cmpuint(size, ==, 1001001);
+  g_free(data);
+  g_free(parent_index);
+
+  g_test_timer_start();
+  girara_node_free(root);
+  g_test_minimized_result(g_test_timer_elapsed(), "freeing a tree with 10^6 nodes built in bulk: %.3fs",
+                          g_test_timer_elapsed());
+}
+
+static void test_datastructures_node_benchmark(void) {
+  g_test_timer_start();
+  girara_tree_node_t* root = build_wide_tree(1000, 1000);
+  g_test_minimized_result(g_test_timer_elapsed(), "building a tree with 10^6 nodes: %.3fs", g_test_timer_elapsed());
+
+  g_test_timer_start();
+  g_assert_cmpuint(count_nodes_list(root), ==, 1001001);
+  g_test_minimized_result(g_test_timer_elapsed(), "walking a tree with 10^6 nodes using children lists: %.3fs",
+                          g_test_timer_elapsed());
+
+  g_test_timer_start();
+  g_assert_cmpuint(count_nodes(root), ==, 1001001);
+  g_test_minimized_result(g_test_timer_elapsed(), "walking a tree with 10^6 nodes using siblings: %.3fs",
+                          g_test_timer_elapsed());
+
+  static const struct {
+    girara_node_traverse_order_t order;
+    const char* name;
+  } orders[] = {
+      {GIRARA_NODE_PRE_ORDER, "pre-order"},
+      {GIRARA_NODE_POST_ORDER, "post-order"},
+      {GIRARA_NODE_LEVEL_ORDER, "level-order"},
+  };
+  for (size_t idx = 0; idx != G_N_ELEMENTS(orders); ++idx) {
+    g_test_timer_start();
+    g_auto(girara_node_iter_t) iter;
+    girara_node_iter_init(&iter, root, orders[idx].order);
+    size_t count = 0;
+    while (girara_node_iter_next(&iter) != NULL) {
+      ++count;
+    }
+    g_assert_cmpuint(count, ==, 1001001);
+    g_test_minimized_result(g_test_timer_elapsed(), "walking a tree with 10^6 nodes using a %s iterator: %.3fs",
+                            orders[idx].name, g_test_timer_elapsed());
+  }
+
+  g_test_timer_start();
+  girara_node_free(root);
+  g_test_minimized_result(g_test_timer_elapsed(), "freeing a tree with 10^6 nodes: %.3fs", g_test_timer_elapsed());
+}
+
+static girara_list_t* trie_collect(girara_trie_t* trie, const char* prefix) {
+  girara_list_t* keys = girara_sorted_list_new_with_free((girara_compare_function_t)g_strcmp0, g_free);
+  g_autoptr(girara_trie_iter_t) iter = girara_trie_iter_new(trie, prefix);
+  g_assert_nonnull(iter);
+
+  const char* key = NULL;
+  void* value     = NULL;
+  while (girara_trie_iter_next(iter, &key, &value) == true) {
+    g_assert_true(g_str_has_prefix(key, prefix));
+    g_assert_cmpstr(key, ==, value);
+    girara_list_append(keys, g_strdup(key));
+  }
+
+  return keys;
+}
+
+static void test_datastructures_trie(void) {
+  static const char* const words[] = {"romane", "romanus", "romulus", "rubens", "ruber", "rubicon", "rubicundus", "r"};
+
+  girara_trie_t* trie = girara_trie_new_with_free(g_free);
+  g_assert_nonnull(trie);
+  g_assert_cmpuint(girara_trie_size(trie), ==, 0);
+  g_assert_null(girara_trie_lookup(trie, "romane"));
+
+  const size_t empty_usage = girara_trie_memory_usage(trie);
+  for (size_t idx = 0; idx != G_N_ELEMENTS(words); ++idx) {
+    g_assert_true(girara_trie_insert(trie, words[idx], g_strdup(words[idx])));
+  }
+  g_assert_cmpuint(girara_trie_size(trie), ==, G_N_ELEMENTS(words));
+  g_assert_cmpuint(girara_trie_memory_usage(trie), >, empty_usage);
+
+  /* replacing a value frees the old one */
+  g_assert_false(girara_trie_insert(trie, "ruber", g_strdup("ruber")));
+  g_assert_cmpuint(girara_trie_size(trie), ==, G_N_ELEMENTS(words));
+
+  for (size_t idx = 0; idx != G_N_ELEMENTS(words); ++idx) {
+    g_assert_true(girara_trie_contains(trie, words[idx]));
+    g_assert_cmpstr(girara_trie_lookup(trie, words[idx]), ==, words[idx]);
+  }
+  g_assert_false(girara_trie_contains(trie, ""));
+  g_assert_false(girara_trie_contains(trie, "rom"));
+  g_assert_false(girara_trie_contains(trie, "romanes"));
+  g_assert_null(girara_trie_lookup(trie, "rub"));
+
+  /* prefixes ending on and within edges */
+  g_assert_cmpuint(girara_trie_count_prefix(trie, ""), ==, 8);
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "r"), ==, 8);
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "rom"), ==, 3);
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "roma"), ==, 2);
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "rubic"), ==, 2);
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "rubicu"), ==, 1);
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "rx"), ==, 0);
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "romanusx"), ==, 0);
+
+  {
+    g_autoptr(girara_list_t) keys = trie_collect(trie, "rub");
+    g_assert_cmpuint(girara_list_size(keys), ==, 4);
+    g_assert_cmpstr(girara_list_nth(keys, 0), ==, "rubens");
+    g_assert_cmpstr(girara_list_nth(keys, 1), ==, "ruber");
+    g_assert_cmpstr(girara_list_nth(keys, 2), ==, "rubicon");
+    g_assert_cmpstr(girara_list_nth(keys, 3), ==, "rubicundus");
+  }
+  {
+    g_autoptr(girara_list_t) keys = trie_collect(trie, "rubicu");
+    g_assert_cmpuint(girara_list_size(keys), ==, 1);
+    g_assert_cmpstr(girara_list_nth(keys, 0), ==, "rubicundus");
+  }
+  {
+    g_autoptr(girara_list_t) keys = trie_collect(trie, "");
+    g_assert_cmpuint(girara_list_size(keys), ==, G_N_ELEMENTS(words));
+  }
+  {
+    g_autoptr(girara_list_t) keys = trie_collect(trie, "x");
+    g_assert_cmpuint(girara_list_size(keys), ==, 0);
+  }
+
+  /* removing entries merges the remaining edges */
+  const size_t full_usage = girara_trie_memory_usage(trie);
+  g_assert_false(girara_trie_remove(trie, "rom"));
+  g_assert_false(girara_trie_remove(trie, "romanusx"));
+  g_assert_true(girara_trie_remove(trie, "romane"));
+  g_assert_false(girara_trie_remove(trie, "romane"));
+  g_assert_true(girara_trie_remove(trie, "r"));
+  g_assert_cmpuint(girara_trie_size(trie), ==, G_N_ELEMENTS(words) - 2);
+  g_assert_cmpuint(girara_trie_memory_usage(trie), <, full_usage);
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "r"), ==, 6);
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "roma"), ==, 1);
+  g_assert_cmpstr(girara_trie_lookup(trie, "romanus"), ==, "romanus");
+  g_assert_cmpstr(girara_trie_lookup(trie, "romulus"), ==, "romulus");
+
+  for (size_t idx = 0; idx != G_N_ELEMENTS(words); ++idx) {
+    girara_trie_remove(trie, words[idx]);
+  }
+  g_assert_cmpuint(girara_trie_size(trie), ==, 0);
+  g_assert_cmpuint(girara_trie_memory_usage(trie), ==, empty_usage);
+
+  /* many keys sharing the first byte use the index of the node */
+  for (size_t idx = 0; idx != 1000; ++idx) {
+    char* key = g_strdup_printf("%zu", idx);
+    g_assert_true(girara_trie_insert(trie, key, key));
+  }
+  for (size_t idx = 0; idx != 1000; idx += 2) {
+    g_autofree char* key = g_strdup_printf("%zu", idx);
+    g_assert_true(girara_trie_remove(trie, key));
+  }
+  for (size_t idx = 0; idx != 1000; ++idx) {
+    g_autofree char* key = g_strdup_printf("%zu", idx);
+    g_assert_true(girara_trie_contains(trie, key) == (idx % 2 == 1));
+  }
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "1"), ==, 56);
+
+  /* removing leaves found through the index of their parent */
+  for (char c = 'a'; c <= 'z'; ++c) {
+    char* key = g_strdup_printf("k%c", c);
+    g_assert_true(girara_trie_insert(trie, key, key));
+  }
+  for (char c = 'a'; c <= 'z'; c += 2) {
+    g_autofree char* key = g_strdup_printf("k%c", c);
+    g_assert_true(girara_trie_remove(trie, key));
+  }
+  g_assert_cmpuint(girara_trie_count_prefix(trie, "k"), ==, 13);
+  g_assert_true(girara_trie_contains(trie, "kz"));
+
+  girara_trie_free(trie);
+}
+
+static void test_datastructures_trie_benchmark(void) {
+  static const size_t size = 1000000;
+
+  g_autoptr(girara_trie_t) trie = girara_trie_new_with_free(g_free);
+  g_autoptr(girara_list_t) list = girara_list_new_with_free(g_free);
+  for (size_t idx = 0; idx != size; ++idx) {
+    girara_list_append(list, g_strdup_printf(":open /home/user/documents/%06zu.pdf", idx));
+  }
+
+  g_test_timer_start();
+  for (size_t idx = 0; idx != size; ++idx) {
+    const char* key = girara_list_nth(list, idx);
+    girara_trie_insert(trie, key, g_strdup(key));
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "inserting 10^6 keys into a trie: %.3fs", g_test_timer_elapsed());
+  g_assert_cmpuint(girara_trie_size(trie), ==, size);
+  g_test_message("trie memory usage: %zu bytes", girara_trie_memory_usage(trie));
+
+  static const char* const prefixes[] = {":open /home/user/documents/12345", ":open /home/user/documents/12",
+                                         ":open /home/user/documents/1"};
+  for (size_t idx = 0; idx != G_N_ELEMENTS(prefixes); ++idx) {
+    const char* prefix = prefixes[idx];
+
+    g_test_timer_start();
+    size_t list_count = 0;
+    for (size_t pos = 0; pos != size; ++pos) {
+      if (g_str_has_prefix(girara_list_nth(list, pos), prefix) == TRUE) {
+        ++list_count;
+      }
+    }
+    g_test_minimized_result(g_test_timer_elapsed(), "enumerating '%s' in a list of 10^6 keys: %.3fs", prefix,
+                            g_test_timer_elapsed());
+
+    g_test_timer_start();
+    size_t trie_count = 0;
+    g_autoptr(girara_trie_iter_t) iter = girara_trie_iter_new(trie, prefix);
+    while (girara_trie_iter_next(iter, NULL, NULL) == true) {
+      ++trie_count;
+    }
+    g_test_minimized_result(g_test_timer_elapsed(), "enumerating '%s' in a trie of 10^6 keys: %.3fs", prefix,
+                            g_test_timer_elapsed());
+
+    g_assert_cmpuint(trie_count, ==, list_count);
+    g_assert_cmpuint(girara_trie_count_prefix(trie, prefix), ==, list_count);
+  }
+}
+
 static int find_compare(const void* item, const void* data) {
   if (item == data) {
     return 1;
@@ -367,11 +1713,40 @@ int main(int argc, char* argv[]) {
   g_test_add_func("/list/free_function", test_datastructures_list_free_free_function);
   g_test_add_func("/list/free_function_remove", test_datastructures_list_free_free_function_remove);
   g_test_add_func("/list/basic", test_datastructures_list);
+  g_test_add_func("/list/reset", test_datastructures_list_reset);
   g_test_add_func("/list/sorted_basic", test_datastructures_sorted_list_basic);
   g_test_add_func("/list/sorted", test_datastructures_sorted_list);
   g_test_add_func("/list/merge", test_datastructures_list_merge);
   g_test_add_func("/list/search", test_datastructures_list_find);
   g_test_add_func("/list/prepand", test_datastructures_list_prepend);
+  g_test_add_func("/list/partial_sort", test_datastructures_list_partial_sort);
+  g_test_add_func("/list/select_nth", test_datastructures_list_select_nth);
+  g_test_add_func("/list/find_many", test_datastructures_list_find_many);
   g_test_add_func("/node/basic", test_datastructures_node);
+  g_test_add_func("/node/children", test_datastructures_node_children);
+  g_test_add_func("/node/depth", test_datastructures_node_depth);
+  g_test_add_func("/node/free_deep", test_datastructures_node_free_deep);
+  g_test_add_func("/node/traverse", test_datastructures_node_traverse);
+  g_test_add_func("/node/find_child", test_datastructures_node_find_child);
+  g_test_add_func("/node/restructure", test_datastructures_node_restructure);
+  g_test_add_func("/node/build", test_datastructures_node_build);
+  g_test_add_func("/node/flat_tree", test_datastructures_flat_tree);
+  g_test_add_func("/node/serialize", test_datastructures_node_serialize);
+  g_test_add_func("/node/free_parallel", test_datastructures_node_free_parallel);
+  g_test_add_func("/node/pool", test_datastructures_node_pool);
+  g_test_add_func("/trie/basic", test_datastructures_trie);
+
+  if (g_test_perf()) {
+    g_test_add_func("/list/partial_sort/benchmark", test_datastructures_list_partial_sort_benchmark);
+    g_test_add_func("/list/find_many/benchmark", test_datastructures_list_find_many_benchmark);
+    g_test_add_func("/node/benchmark", test_datastructures_node_benchmark);
+    g_test_add_func("/node/pool/benchmark", test_datastructures_node_pool_benchmark);
+    g_test_add_func("/node/free/benchmark", test_datastructures_node_free_benchmark);
+    g_test_add_func("/node/find_child/benchmark", test_datastructures_node_find_child_benchmark);
+    g_test_add_func("/node/flat_tree/benchmark", test_datastructures_flat_tree_benchmark);
+    g_test_add_func("/node/serialize/benchmark", test_datastructures_node_serialize_benchmark);
+    g_test_add_func("/node/build/benchmark", test_datastructures_node_build_benchmark);
+    g_test_add_func("/trie/benchmark", test_datastructures_trie_benchmark);
+  }
   return g_test_run();
 }
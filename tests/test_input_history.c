@@ -0,0 +1,1400 @@
+/* SPDX-License-Identifier: Zlib */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "input-history.h"
+#include "input-history-file-io.h"
+#include "datastructures.h"
+
+/* Input history storage in memory */
+G_DECLARE_FINAL_TYPE(TestHistoryIO, test_history_io, TEST, HISTORY_IO, GObject)
+
+struct _TestHistoryIO {
+  GObject parent;
+  girara_list_t* inputs;
+  girara_list_t* evicted;
+  bool rewritten;    /**< The inputs were replaced since the last read */
+  size_t full_reads; /**< Number of reads returning all inputs */
+  size_t read_items; /**< Number of returned inputs */
+  size_t batches;    /**< Number of batches written */
+};
+
+static void test_history_io_iface_init(GiraraInputHistoryIOInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(TestHistoryIO, test_history_io, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GIRARA_TYPE_INPUT_HISTORY_IO, test_history_io_iface_init))
+
+static void test_history_io_init(TestHistoryIO* io) {
+  io->inputs  = girara_list_new_with_free(g_free);
+  io->evicted = girara_list_new_with_free(g_free);
+}
+
+static void test_history_io_finalize(GObject* object) {
+  TestHistoryIO* io = TEST_HISTORY_IO(object);
+  girara_list_free(io->inputs);
+  girara_list_free(io->evicted);
+
+  G_OBJECT_CLASS(test_history_io_parent_class)->finalize(object);
+}
+
+static void test_history_io_class_init(TestHistoryIOClass* class) {
+  G_OBJECT_CLASS(class)->finalize = test_history_io_finalize;
+}
+
+static void test_history_io_append(GiraraInputHistoryIO* object, const char* input) {
+  TestHistoryIO* io = TEST_HISTORY_IO(object);
+  girara_list_append(io->inputs, g_strdup(input));
+}
+
+static girara_list_t* test_history_io_read_since(GiraraInputHistoryIO* object, guint64* cursor, bool* reload) {
+  TestHistoryIO* io = TEST_HISTORY_IO(object);
+  if (io->rewritten == true || *cursor > girara_list_size(io->inputs)) {
+    *reload = true;
+  }
+  if (*reload == true) {
+    *cursor = 0;
+    ++io->full_reads;
+  }
+
+  girara_list_t* list = girara_list_new_with_free(g_free);
+  for (size_t idx = *cursor; idx != girara_list_size(io->inputs); ++idx) {
+    girara_list_append(list, g_strdup(girara_list_nth(io->inputs, idx)));
+  }
+
+  io->read_items += girara_list_size(list);
+  io->rewritten = false;
+  *cursor       = girara_list_size(io->inputs);
+  return list;
+}
+
+static girara_list_t* test_history_io_read(GiraraInputHistoryIO* object) {
+  guint64 cursor = 0;
+  bool reload    = true;
+  return test_history_io_read_since(object, &cursor, &reload);
+}
+
+static void test_history_io_evict(GiraraInputHistoryIO* object, const char* input) {
+  TestHistoryIO* io = TEST_HISTORY_IO(object);
+  girara_list_append(io->evicted, g_strdup(input));
+}
+
+static void test_history_io_append_batch(GiraraInputHistoryIO* object, girara_list_t* inputs, guint64* cursor) {
+  TestHistoryIO* io = TEST_HISTORY_IO(object);
+  if (cursor != NULL && io->rewritten == false && *cursor == girara_list_size(io->inputs)) {
+    *cursor += girara_list_size(inputs);
+  }
+  for (size_t idx = 0; idx != girara_list_size(inputs); ++idx) {
+    girara_list_append(io->inputs, g_strdup(girara_list_nth(inputs, idx)));
+  }
+  ++io->batches;
+}
+
+static void test_history_io_iface_init(GiraraInputHistoryIOInterface* iface) {
+  iface->append       = test_history_io_append;
+  iface->read         = test_history_io_read;
+  iface->read_since   = test_history_io_read_since;
+  iface->evict        = test_history_io_evict;
+  iface->append_batch = test_history_io_append_batch;
+}
+
+static TestHistoryIO* test_history_io_new(const char* const* inputs, size_t size) {
+  TestHistoryIO* io = g_object_new(test_history_io_get_type(), NULL);
+  for (size_t idx = 0; idx != size; ++idx) {
+    girara_list_append(io->inputs, g_strdup(inputs[idx]));
+  }
+
+  return io;
+}
+
+/* Input history storage that takes its time and only implements the
+ * asynchronous methods */
+G_DECLARE_FINAL_TYPE(SlowHistoryIO, slow_history_io, SLOW, HISTORY_IO, GObject)
+
+struct _SlowHistoryIO {
+  GObject parent;
+  TestHistoryIO* storage;
+  guint delay;    /**< Delay of every operation in milliseconds */
+  size_t pending; /**< Number of operations in progress */
+};
+
+static void slow_history_io_iface_init(GiraraInputHistoryIOInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(SlowHistoryIO, slow_history_io, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GIRARA_TYPE_INPUT_HISTORY_IO, slow_history_io_iface_init))
+
+static void slow_history_io_init(SlowHistoryIO* GIRARA_UNUSED(io)) {}
+
+static void slow_history_io_finalize(GObject* object) {
+  SlowHistoryIO* io = SLOW_HISTORY_IO(object);
+  g_object_unref(io->storage);
+
+  G_OBJECT_CLASS(slow_history_io_parent_class)->finalize(object);
+}
+
+static void slow_history_io_class_init(SlowHistoryIOClass* class) {
+  G_OBJECT_CLASS(class)->finalize = slow_history_io_finalize;
+}
+
+static void slow_history_io_append(GiraraInputHistoryIO* GIRARA_UNUSED(object), const char* GIRARA_UNUSED(input)) {
+  g_assert_not_reached();
+}
+
+static girara_list_t* slow_history_io_read(GiraraInputHistoryIO* GIRARA_UNUSED(object)) {
+  g_assert_not_reached();
+}
+
+static gboolean slow_history_io_append_done(gpointer data) {
+  GTask* task       = data;
+  SlowHistoryIO* io = g_task_get_source_object(task);
+  test_history_io_append(GIRARA_INPUT_HISTORY_IO(io->storage), g_task_get_task_data(task));
+  --io->pending;
+
+  g_task_return_boolean(task, TRUE);
+  g_object_unref(task);
+  return G_SOURCE_REMOVE;
+}
+
+static void slow_history_io_append_async(GiraraInputHistoryIO* object, const char* input, GCancellable* cancellable,
+                                         GAsyncReadyCallback callback, gpointer user_data) {
+  SlowHistoryIO* io = SLOW_HISTORY_IO(object);
+  GTask* task       = g_task_new(io, cancellable, callback, user_data);
+  g_task_set_task_data(task, g_strdup(input), g_free);
+
+  ++io->pending;
+  g_timeout_add(io->delay, slow_history_io_append_done, task);
+}
+
+static bool slow_history_io_append_finish(GiraraInputHistoryIO* GIRARA_UNUSED(object), GAsyncResult* result,
+                                          GError** error) {
+  return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+/**
+ * State of a read
+ */
+typedef struct slow_read_s {
+  guint64 cursor;
+  bool reload;
+} slow_read_t;
+
+static gboolean slow_history_io_read_done(gpointer data) {
+  GTask* task       = data;
+  SlowHistoryIO* io = g_task_get_source_object(task);
+  slow_read_t* read = g_task_get_task_data(task);
+  read->reload      = read->cursor == 0;
+  girara_list_t* inputs =
+      test_history_io_read_since(GIRARA_INPUT_HISTORY_IO(io->storage), &read->cursor, &read->reload);
+  --io->pending;
+
+  g_task_return_pointer(task, inputs, (GDestroyNotify)girara_list_free);
+  g_object_unref(task);
+  return G_SOURCE_REMOVE;
+}
+
+static void slow_history_io_read_async(GiraraInputHistoryIO* object, guint64 cursor, GCancellable* cancellable,
+                                       GAsyncReadyCallback callback, gpointer user_data) {
+  SlowHistoryIO* io = SLOW_HISTORY_IO(object);
+  GTask* task       = g_task_new(io, cancellable, callback, user_data);
+  slow_read_t* read = g_new0(slow_read_t, 1);
+  read->cursor      = cursor;
+  g_task_set_task_data(task, read, g_free);
+
+  ++io->pending;
+  g_timeout_add(io->delay, slow_history_io_read_done, task);
+}
+
+static girara_list_t* slow_history_io_read_finish(GiraraInputHistoryIO* GIRARA_UNUSED(object), GAsyncResult* result,
+                                                  guint64* cursor, bool* reload, GError** error) {
+  const slow_read_t* read = g_task_get_task_data(G_TASK(result));
+  *cursor                 = read->cursor;
+  *reload                 = read->reload;
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void slow_history_io_iface_init(GiraraInputHistoryIOInterface* iface) {
+  iface->append        = slow_history_io_append;
+  iface->read          = slow_history_io_read;
+  iface->append_async  = slow_history_io_append_async;
+  iface->append_finish = slow_history_io_append_finish;
+  iface->read_async    = slow_history_io_read_async;
+  iface->read_finish   = slow_history_io_read_finish;
+}
+
+static SlowHistoryIO* slow_history_io_new(TestHistoryIO* storage, guint delay) {
+  SlowHistoryIO* io = g_object_new(slow_history_io_get_type(), NULL);
+  io->storage       = g_object_ref(storage);
+  io->delay         = delay;
+
+  return io;
+}
+
+static void slow_history_io_wait(SlowHistoryIO* io) {
+  while (io->pending != 0) {
+    g_main_context_iteration(NULL, TRUE);
+  }
+}
+
+/* Input history storage that only implements one half of each pair of
+ * asynchronous methods */
+G_DECLARE_FINAL_TYPE(HalfHistoryIO, half_history_io, HALF, HISTORY_IO, GObject)
+
+struct _HalfHistoryIO {
+  GObject parent;
+};
+
+static void half_history_io_iface_init(GiraraInputHistoryIOInterface* iface);
+
+G_DEFINE_TYPE_WITH_CODE(HalfHistoryIO, half_history_io, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(GIRARA_TYPE_INPUT_HISTORY_IO, half_history_io_iface_init))
+
+static void half_history_io_init(HalfHistoryIO* GIRARA_UNUSED(io)) {}
+
+static void half_history_io_class_init(HalfHistoryIOClass* GIRARA_UNUSED(class)) {}
+
+static void half_history_io_append_async(GiraraInputHistoryIO* GIRARA_UNUSED(object),
+                                         const char* GIRARA_UNUSED(input), GCancellable* GIRARA_UNUSED(cancellable),
+                                         GAsyncReadyCallback GIRARA_UNUSED(callback),
+                                         gpointer GIRARA_UNUSED(user_data)) {
+  g_assert_not_reached();
+}
+
+static girara_list_t* half_history_io_read_finish(GiraraInputHistoryIO* GIRARA_UNUSED(object),
+                                                  GAsyncResult* GIRARA_UNUSED(result), guint64* GIRARA_UNUSED(cursor),
+                                                  bool* GIRARA_UNUSED(reload), GError** GIRARA_UNUSED(error)) {
+  g_assert_not_reached();
+}
+
+static void half_history_io_iface_init(GiraraInputHistoryIOInterface* iface) {
+  iface->append       = slow_history_io_append;
+  iface->read         = slow_history_io_read;
+  iface->append_async = half_history_io_append_async;
+  iface->read_finish  = half_history_io_read_finish;
+}
+
+/* Input history that lists fixed inputs instead of the stored ones */
+G_DECLARE_FINAL_TYPE(FixedHistory, fixed_history, FIXED, HISTORY, GiraraInputHistory)
+
+struct _FixedHistory {
+  GiraraInputHistory parent;
+  girara_list_t* inputs;
+};
+
+G_DEFINE_TYPE(FixedHistory, fixed_history, GIRARA_TYPE_INPUT_HISTORY)
+
+static void fixed_history_init(FixedHistory* history) {
+  history->inputs = girara_list_new_with_free(g_free);
+}
+
+static void fixed_history_finalize(GObject* object) {
+  FixedHistory* history = FIXED_HISTORY(object);
+  girara_list_free(history->inputs);
+
+  G_OBJECT_CLASS(fixed_history_parent_class)->finalize(object);
+}
+
+static girara_list_t* fixed_history_list(GiraraInputHistory* history) {
+  return FIXED_HISTORY(history)->inputs;
+}
+
+static void fixed_history_class_init(FixedHistoryClass* class) {
+  G_OBJECT_CLASS(class)->finalize         = fixed_history_finalize;
+  GIRARA_INPUT_HISTORY_CLASS(class)->list = fixed_history_list;
+}
+
+static void assert_history(GiraraInputHistory* history, const char* const* expected, size_t size) {
+  girara_list_t* list = girara_input_history_list(history);
+  g_assert_nonnull(list);
+  g_assert_cmpuint(girara_list_size(list), ==, size);
+
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_assert_cmpstr(girara_list_nth(list, idx), ==, expected[idx]);
+  }
+}
+
+static void test_input_history_append(void) {
+  GiraraInputHistory* history = girara_input_history_new(NULL);
+  g_assert_nonnull(history);
+
+  girara_input_history_append(history, NULL);
+  assert_history(history, NULL, 0);
+
+  girara_input_history_append(history, ":open a");
+  girara_input_history_append(history, ":open b");
+  girara_input_history_append(history, ":quit");
+  static const char* const appended[] = {":open a", ":open b", ":quit"};
+  assert_history(history, appended, G_N_ELEMENTS(appended));
+
+  /* duplicates move to the end */
+  girara_input_history_append(history, ":open a");
+  girara_input_history_append(history, ":quit");
+  girara_input_history_append(history, ":quit");
+  static const char* const moved[] = {":open b", ":open a", ":quit"};
+  assert_history(history, moved, G_N_ELEMENTS(moved));
+
+  /* moving an input invalidates the list */
+  girara_list_t* held = girara_input_history_list(history);
+  girara_input_history_append(history, ":open b");
+  g_assert_cmpuint(girara_list_size(held), ==, 0);
+  g_assert_true(girara_input_history_list(history) == held);
+  static const char* const moved_again[] = {":open a", ":quit", ":open b"};
+  assert_history(history, moved_again, G_N_ELEMENTS(moved_again));
+
+  g_object_unref(history);
+}
+
+static void test_input_history_io(void) {
+  static const char* const stored[] = {":open a", ":open b", ":open a", ":quit"};
+  TestHistoryIO* io = test_history_io_new(stored, G_N_ELEMENTS(stored));
+
+  /* only the most recent occurrence of a stored input is kept */
+  GiraraInputHistory* history = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  static const char* const read[] = {":open b", ":open a", ":quit"};
+  assert_history(history, read, G_N_ELEMENTS(read));
+
+  girara_input_history_append(history, ":open b");
+  static const char* const appended[] = {":open a", ":quit", ":open b"};
+  assert_history(history, appended, G_N_ELEMENTS(appended));
+  g_assert_cmpuint(girara_list_size(io->inputs), ==, G_N_ELEMENTS(stored) + 1);
+  g_assert_cmpstr(girara_list_nth(io->inputs, G_N_ELEMENTS(stored)), ==, ":open b");
+
+  g_object_unref(history);
+  g_object_unref(io);
+}
+
+static void test_input_history_io_incremental(void) {
+  static const char* const stored[] = {":open a", ":open b"};
+  TestHistoryIO* io           = test_history_io_new(stored, G_N_ELEMENTS(stored));
+  GiraraInputHistory* history = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  assert_history(history, stored, G_N_ELEMENTS(stored));
+  g_assert_cmpuint(io->full_reads, ==, 1);
+  g_assert_cmpuint(io->read_items, ==, 2);
+
+  /* appending does not read from the storage, and the appended inputs are
+   * not read again */
+  girara_input_history_append(history, ":open c");
+  girara_input_history_append(history, ":open a");
+  g_assert_cmpuint(io->read_items, ==, 2);
+  static const char* const appended[] = {":open b", ":open c", ":open a"};
+  assert_history(history, appended, G_N_ELEMENTS(appended));
+  girara_input_history_reset(history);
+  g_assert_cmpuint(io->read_items, ==, 2);
+
+  /* only new inputs are read, including those from other writers */
+  girara_list_append(io->inputs, g_strdup(":quit"));
+  girara_input_history_reset(history);
+  g_assert_cmpuint(io->full_reads, ==, 1);
+  g_assert_cmpuint(io->read_items, ==, 3);
+  static const char* const merged[] = {":open b", ":open c", ":open a", ":quit"};
+  assert_history(history, merged, G_N_ELEMENTS(merged));
+
+  /* inputs appended after those of another writer are read again */
+  girara_list_append(io->inputs, g_strdup(":open e"));
+  girara_input_history_append(history, ":open f");
+  girara_input_history_reset(history);
+  g_assert_cmpuint(io->read_items, ==, 5);
+  static const char* const interleaved[] = {":open b", ":open c", ":open a", ":quit", ":open e", ":open f"};
+  assert_history(history, interleaved, G_N_ELEMENTS(interleaved));
+
+  girara_input_history_reset(history);
+  g_assert_cmpuint(io->read_items, ==, 5);
+  assert_history(history, interleaved, G_N_ELEMENTS(interleaved));
+
+  /* the history is reloaded after the storage was rewritten, and a list that
+   * is still held does not point to the freed inputs */
+  girara_list_t* held = girara_input_history_list(history);
+  girara_list_clear(io->inputs);
+  girara_list_append(io->inputs, g_strdup(":open d"));
+  io->rewritten = true;
+  girara_input_history_reset(history);
+  g_assert_cmpuint(io->full_reads, ==, 2);
+  g_assert_cmpuint(girara_list_size(held), ==, 0);
+  static const char* const rewritten[] = {":open d"};
+  assert_history(history, rewritten, G_N_ELEMENTS(rewritten));
+
+  g_object_unref(history);
+  g_object_unref(io);
+}
+
+static void test_input_history_navigate(void) {
+  GiraraInputHistory* history = girara_input_history_new(NULL);
+  g_assert_nonnull(history);
+  g_assert_null(girara_input_history_previous(history, ""));
+
+  girara_input_history_append(history, ":open a");
+  girara_input_history_append(history, ":set b");
+  girara_input_history_append(history, ":open c");
+
+  /* without a prefix, every input is visited */
+  g_assert_cmpstr(girara_input_history_previous(history, ""), ==, ":open c");
+  g_assert_cmpstr(girara_input_history_previous(history, ""), ==, ":set b");
+  g_assert_cmpstr(girara_input_history_previous(history, ""), ==, ":open a");
+  g_assert_null(girara_input_history_previous(history, ""));
+  g_assert_cmpstr(girara_input_history_next(history, ""), ==, ":set b");
+  g_assert_cmpstr(girara_input_history_next(history, ""), ==, ":open c");
+  g_assert_cmpstr(girara_input_history_next(history, ""), ==, "");
+
+  /* only inputs starting with the command line are visited */
+  girara_input_history_reset(history);
+  g_assert_cmpstr(girara_input_history_previous(history, ":o"), ==, ":open c");
+  g_assert_cmpstr(girara_input_history_previous(history, ":open c"), ==, ":open a");
+  g_assert_null(girara_input_history_previous(history, ":open a"));
+  g_assert_cmpstr(girara_input_history_next(history, ":open a"), ==, ":open c");
+  g_assert_cmpstr(girara_input_history_next(history, ":open c"), ==, ":o");
+
+  g_object_unref(history);
+}
+
+static void test_input_history_navigate_moved(void) {
+  GiraraInputHistory* history = girara_input_history_new(NULL);
+  g_assert_nonnull(history);
+
+  /* moved inputs leave gaps behind */
+  static const char* const inputs[] = {":open a", ":set a", ":open b", ":set b", ":open a", ":set a", ":open c"};
+  for (size_t idx = 0; idx != G_N_ELEMENTS(inputs); ++idx) {
+    girara_input_history_append(history, inputs[idx]);
+  }
+
+  g_assert_cmpstr(girara_input_history_previous(history, ":open"), ==, ":open c");
+  g_assert_cmpstr(girara_input_history_previous(history, ":open c"), ==, ":open a");
+  g_assert_cmpstr(girara_input_history_previous(history, ":open a"), ==, ":open b");
+  g_assert_null(girara_input_history_previous(history, ":open b"));
+  g_assert_cmpstr(girara_input_history_next(history, ":open b"), ==, ":open a");
+
+  girara_input_history_reset(history);
+  g_assert_cmpstr(girara_input_history_previous(history, ""), ==, ":open c");
+  g_assert_cmpstr(girara_input_history_previous(history, ""), ==, ":set a");
+  g_assert_cmpstr(girara_input_history_previous(history, ""), ==, ":open a");
+  g_assert_cmpstr(girara_input_history_previous(history, ""), ==, ":set b");
+  g_assert_cmpstr(girara_input_history_next(history, ""), ==, ":open a");
+
+  /* nothing matches */
+  girara_input_history_reset(history);
+  g_assert_null(girara_input_history_previous(history, ":quit"));
+  g_assert_cmpstr(girara_input_history_next(history, ":quit"), ==, ":quit");
+  g_assert_cmpstr(girara_input_history_previous(history, ":set"), ==, ":set a");
+
+  g_object_unref(history);
+}
+
+static void test_input_history_navigate_overridden(void) {
+  FixedHistory* fixed         = g_object_new(fixed_history_get_type(), NULL);
+  GiraraInputHistory* history = GIRARA_INPUT_HISTORY(fixed);
+
+  /* the overridden list is navigated, not the stored inputs */
+  girara_input_history_append(history, ":open a");
+  g_assert_null(girara_input_history_previous(history, ""));
+  girara_list_append(fixed->inputs, g_strdup(":open b"));
+  girara_list_append(fixed->inputs, g_strdup(":set c"));
+  girara_list_append(fixed->inputs, g_strdup(":open d"));
+
+  girara_input_history_reset(history);
+  g_assert_cmpstr(girara_input_history_previous(history, ":o"), ==, ":open d");
+  g_assert_cmpstr(girara_input_history_previous(history, ":open d"), ==, ":open b");
+  g_assert_null(girara_input_history_previous(history, ":open b"));
+  g_assert_cmpstr(girara_input_history_next(history, ":open b"), ==, ":open d");
+  g_assert_cmpstr(girara_input_history_next(history, ":open d"), ==, ":o");
+
+  g_object_unref(history);
+}
+
+static void test_input_history_navigate_read(void) {
+  static const char* const stored[] = {":open a", ":open b", ":open c"};
+  g_autoptr(TestHistoryIO) io       = test_history_io_new(stored, G_N_ELEMENTS(stored));
+  GiraraInputHistory* history       = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+
+  /* inputs read while navigating do not start it over */
+  g_assert_cmpstr(girara_input_history_previous(history, ":o"), ==, ":open c");
+  g_assert_cmpstr(girara_input_history_previous(history, ":open c"), ==, ":open b");
+  girara_list_append(io->inputs, g_strdup(":quit"));
+  girara_list_append(io->inputs, g_strdup(":open c"));
+  g_signal_emit_by_name(io, "changed");
+  g_assert_cmpstr(girara_input_history_previous(history, ":open b"), ==, ":open a");
+  g_assert_cmpstr(girara_input_history_next(history, ":open a"), ==, ":open b");
+  g_assert_cmpstr(girara_input_history_next(history, ":open b"), ==, ":open c");
+  g_assert_cmpstr(girara_input_history_next(history, ":open c"), ==, ":o");
+
+  /* unless the current match was moved */
+  g_assert_cmpstr(girara_input_history_previous(history, ":o"), ==, ":open c");
+  g_assert_cmpstr(girara_input_history_previous(history, ":open c"), ==, ":open b");
+  girara_list_append(io->inputs, g_strdup(":open b"));
+  g_signal_emit_by_name(io, "changed");
+  g_assert_cmpstr(girara_input_history_previous(history, ":open"), ==, ":open b");
+  g_assert_cmpstr(girara_input_history_previous(history, ":open b"), ==, ":open c");
+
+  g_object_unref(history);
+}
+
+static void test_input_history_io_async(void) {
+  static const char* const stored[] = {":open a", ":open b"};
+  g_autoptr(TestHistoryIO) storage  = test_history_io_new(stored, G_N_ELEMENTS(stored));
+  g_autoptr(SlowHistoryIO) io       = slow_history_io_new(storage, 20);
+
+  /* the stored inputs show up once they are read */
+  GiraraInputHistory* history = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  assert_history(history, NULL, 0);
+  g_assert_cmpuint(io->pending, ==, 1);
+  slow_history_io_wait(io);
+  assert_history(history, stored, G_N_ELEMENTS(stored));
+
+  /* appending does not wait for the storage, which sees the inputs in order */
+  girara_input_history_append(history, ":open c");
+  girara_input_history_append(history, ":open a");
+  girara_input_history_append(history, ":quit");
+  static const char* const appended[] = {":open b", ":open c", ":open a", ":quit"};
+  assert_history(history, appended, G_N_ELEMENTS(appended));
+  g_assert_cmpuint(girara_list_size(storage->inputs), ==, 2);
+
+  /* a read finishing before the writes does not reorder the inputs */
+  girara_input_history_reset(history);
+  girara_input_history_reset(history);
+  slow_history_io_wait(io);
+  assert_history(history, appended, G_N_ELEMENTS(appended));
+  g_assert_cmpuint(girara_list_size(storage->inputs), ==, 5);
+  g_assert_cmpstr(girara_list_nth(storage->inputs, 2), ==, ":open c");
+  g_assert_cmpstr(girara_list_nth(storage->inputs, 3), ==, ":open a");
+  g_assert_cmpstr(girara_list_nth(storage->inputs, 4), ==, ":quit");
+
+  /* pending writes are not lost */
+  girara_input_history_append(history, ":open d");
+  g_object_unref(history);
+  slow_history_io_wait(io);
+  g_assert_cmpuint(girara_list_size(storage->inputs), ==, 6);
+  g_assert_cmpstr(girara_list_nth(storage->inputs, 5), ==, ":open d");
+}
+
+static void test_io_async_done(GObject* GIRARA_UNUSED(source), GAsyncResult* result, gpointer data) {
+  *(GAsyncResult**)data = g_object_ref(result);
+}
+
+static void test_input_history_io_async_fallback(void) {
+  static const char* const stored[] = {":open a", ":open b"};
+  g_autoptr(TestHistoryIO) io       = test_history_io_new(stored, G_N_ELEMENTS(stored));
+
+  /* storage without the asynchronous methods */
+  GAsyncResult* result = NULL;
+  girara_input_history_io_append_async(GIRARA_INPUT_HISTORY_IO(io), ":quit", NULL, test_io_async_done, &result);
+  while (result == NULL) {
+    g_main_context_iteration(NULL, TRUE);
+  }
+  g_assert_true(girara_input_history_io_append_finish(GIRARA_INPUT_HISTORY_IO(io), result, NULL));
+  g_assert_cmpuint(girara_list_size(io->inputs), ==, 3);
+  g_clear_object(&result);
+
+  girara_input_history_io_read_async(GIRARA_INPUT_HISTORY_IO(io), 2, NULL, test_io_async_done, &result);
+  while (result == NULL) {
+    g_main_context_iteration(NULL, TRUE);
+  }
+  guint64 cursor                  = 0;
+  bool reload                     = true;
+  g_autoptr(girara_list_t) inputs =
+      girara_input_history_io_read_finish(GIRARA_INPUT_HISTORY_IO(io), result, &cursor, &reload, NULL);
+  g_clear_object(&result);
+  g_assert_nonnull(inputs);
+  g_assert_cmpuint(girara_list_size(inputs), ==, 1);
+  g_assert_cmpstr(girara_list_nth(inputs, 0), ==, ":quit");
+  g_assert_cmpuint(cursor, ==, 3);
+  g_assert_false(reload);
+
+  /* batches are written with the synchronous method and move the cursor */
+  g_autoptr(girara_list_t) batch = girara_list_new();
+  girara_list_append(batch, ":open c");
+  girara_list_append(batch, ":open d");
+  girara_input_history_io_append_batch_async(GIRARA_INPUT_HISTORY_IO(io), batch, 3, NULL, test_io_async_done, &result);
+  while (result == NULL) {
+    g_main_context_iteration(NULL, TRUE);
+  }
+  g_assert_true(girara_input_history_io_append_batch_finish(GIRARA_INPUT_HISTORY_IO(io), result, &cursor, NULL));
+  g_clear_object(&result);
+  g_assert_cmpuint(cursor, ==, 5);
+  g_assert_cmpuint(io->batches, ==, 1);
+
+  /* storage with only one half of the asynchronous methods */
+  g_autoptr(HalfHistoryIO) half = g_object_new(half_history_io_get_type(), NULL);
+  g_test_expect_message(NULL, G_LOG_LEVEL_CRITICAL, "*assertion*failed*");
+  girara_input_history_io_append_async(GIRARA_INPUT_HISTORY_IO(half), ":quit", NULL, test_io_async_done, &result);
+  g_test_expect_message(NULL, G_LOG_LEVEL_CRITICAL, "*assertion*failed*");
+  girara_input_history_io_read_async(GIRARA_INPUT_HISTORY_IO(half), 0, NULL, test_io_async_done, &result);
+  g_test_assert_expected_messages();
+  g_assert_null(result);
+}
+
+static void assert_stored(girara_list_t* inputs, const char* const* expected, size_t size) {
+  g_assert_cmpuint(girara_list_size(inputs), ==, size);
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_assert_cmpstr(girara_list_nth(inputs, idx), ==, expected[idx]);
+  }
+}
+
+static void test_input_history_flush(void) {
+  g_autoptr(TestHistoryIO) io = test_history_io_new(NULL, 0);
+  GiraraInputHistory* history = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  g_object_set(history, "flush-threshold", 3, "flush-interval", 0, NULL);
+
+  /* inputs are written once enough came together */
+  girara_input_history_append(history, ":open a");
+  girara_input_history_append(history, ":open b");
+  g_assert_cmpuint(girara_list_size(io->inputs), ==, 0);
+  girara_input_history_append(history, ":open c");
+  static const char* const threshold[] = {":open a", ":open b", ":open c"};
+  assert_stored(io->inputs, threshold, G_N_ELEMENTS(threshold));
+  g_assert_cmpuint(io->batches, ==, 1);
+
+  /* or when asked to */
+  girara_input_history_append(history, ":open d");
+  girara_input_history_flush(history);
+  g_assert_cmpuint(girara_list_size(io->inputs), ==, 4);
+  g_assert_cmpuint(io->batches, ==, 2);
+
+  /* or once the main loop is idle */
+  girara_input_history_append(history, ":open e");
+  girara_input_history_append(history, ":open a");
+  while (girara_list_size(io->inputs) != 6) {
+    g_main_context_iteration(NULL, TRUE);
+  }
+  g_assert_cmpuint(io->batches, ==, 3);
+
+  /* collected inputs are the most recent ones when reading from io */
+  girara_input_history_append(history, ":open b");
+  girara_input_history_reset(history);
+  static const char* const collected[] = {":open c", ":open d", ":open e", ":open a", ":open b"};
+  assert_history(history, collected, G_N_ELEMENTS(collected));
+
+  /* and are written when the history goes away */
+  girara_input_history_append(history, ":quit");
+  g_object_unref(history);
+  static const char* const finalized[] = {":open a", ":open b", ":open c", ":open d",
+                                          ":open e", ":open a", ":open b", ":quit"};
+  assert_stored(io->inputs, finalized, G_N_ELEMENTS(finalized));
+  g_assert_cmpuint(io->batches, ==, 4);
+}
+
+static void test_input_history_flush_async(void) {
+  g_autoptr(TestHistoryIO) storage = test_history_io_new(NULL, 0);
+  g_autoptr(SlowHistoryIO) io      = slow_history_io_new(storage, 1);
+  GiraraInputHistory* history      = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  g_object_set(history, "flush-threshold", 100, NULL);
+  slow_history_io_wait(io);
+
+  for (size_t idx = 0; idx != 10; ++idx) {
+    g_autofree char* input = g_strdup_printf(":open %zu", idx);
+    girara_input_history_append(history, input);
+  }
+  g_assert_cmpuint(io->pending, ==, 0);
+
+  /* nothing collected is lost when the history goes away */
+  g_object_unref(history);
+  slow_history_io_wait(io);
+  g_assert_cmpuint(girara_list_size(storage->inputs), ==, 10);
+  for (size_t idx = 0; idx != 10; ++idx) {
+    g_autofree char* input = g_strdup_printf(":open %zu", idx);
+    g_assert_cmpstr(girara_list_nth(storage->inputs, idx), ==, input);
+  }
+
+  /* inputs go to the io that was set when they were appended */
+  g_autoptr(TestHistoryIO) other_storage = test_history_io_new(NULL, 0);
+  g_autoptr(SlowHistoryIO) other         = slow_history_io_new(other_storage, 1);
+  history                                = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  slow_history_io_wait(io);
+  girara_input_history_append(history, ":open a");
+  g_object_set(history, "io", other, NULL);
+  girara_input_history_append(history, ":open b");
+  g_object_unref(history);
+  slow_history_io_wait(io);
+  slow_history_io_wait(other);
+  g_assert_cmpuint(girara_list_size(storage->inputs), ==, 11);
+  g_assert_cmpstr(girara_list_nth(storage->inputs, 10), ==, ":open a");
+  g_assert_cmpuint(girara_list_size(other_storage->inputs), ==, 1);
+  g_assert_cmpstr(girara_list_nth(other_storage->inputs, 0), ==, ":open b");
+}
+
+static char* file_io_path(void) {
+  g_autofree char* directory = g_dir_make_tmp("girara-history-XXXXXX", NULL);
+  g_assert_nonnull(directory);
+
+  return g_build_filename(directory, "history", NULL);
+}
+
+static void file_io_remove(const char* path) {
+  g_unlink(path);
+  g_autofree char* directory = g_path_get_dirname(path);
+  g_rmdir(directory);
+}
+
+static void assert_file(const char* path, const char* expected) {
+  g_autofree char* contents = NULL;
+  g_assert_true(g_file_get_contents(path, &contents, NULL, NULL));
+  g_assert_cmpstr(contents, ==, expected);
+}
+
+static void test_input_history_file_io(void) {
+  g_autofree char* path = file_io_path();
+
+  g_autoptr(GiraraInputHistoryFileIO) io = girara_input_history_file_io_new(path);
+  GiraraInputHistory* history            = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  assert_history(history, NULL, 0);
+
+  /* inputs are appended as lines, inputs spanning several lines are only kept
+   * in memory */
+  girara_input_history_append(history, ":open a");
+  girara_input_history_append(history, ":open b");
+  girara_input_history_append(history, ":open\nc");
+  girara_input_history_append(history, ":open a");
+  assert_file(path, ":open a\n:open b\n:open a\n");
+  static const char* const appended[] = {":open b", ":open\nc", ":open a"};
+  assert_history(history, appended, G_N_ELEMENTS(appended));
+  g_object_unref(history);
+
+  g_autoptr(GiraraInputHistoryFileIO) other = girara_input_history_file_io_new(path);
+  history                                   = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(other));
+  static const char* const read[]           = {":open b", ":open a"};
+  assert_history(history, read, G_N_ELEMENTS(read));
+  g_object_unref(history);
+
+  /* only complete lines are read */
+  guint64 cursor = 0;
+  bool reload    = false;
+  g_autoptr(girara_list_t) all =
+      girara_input_history_io_read_since(GIRARA_INPUT_HISTORY_IO(other), &cursor, &reload);
+  g_assert_true(reload);
+  g_assert_cmpuint(girara_list_size(all), ==, 3);
+
+  FILE* file = fopen(path, "a");
+  fputs(":quit", file);
+  fflush(file);
+  g_autoptr(girara_list_t) partial =
+      girara_input_history_io_read_since(GIRARA_INPUT_HISTORY_IO(other), &cursor, &reload);
+  g_assert_false(reload);
+  g_assert_cmpuint(girara_list_size(partial), ==, 0);
+
+  fputs("\n", file);
+  fclose(file);
+  g_autoptr(girara_list_t) complete =
+      girara_input_history_io_read_since(GIRARA_INPUT_HISTORY_IO(other), &cursor, &reload);
+  g_assert_false(reload);
+  g_assert_cmpuint(girara_list_size(complete), ==, 1);
+  g_assert_cmpstr(girara_list_nth(complete, 0), ==, ":quit");
+
+  file_io_remove(path);
+}
+
+static void test_input_history_file_io_compact(void) {
+  g_autofree char* path = file_io_path();
+  g_assert_true(g_file_set_contents(path, ":open a\n:open b\n:open a\n:open c\n:quit\n", -1, NULL));
+
+  g_autoptr(GiraraInputHistoryFileIO) io = girara_input_history_file_io_new(path);
+  guint64 cursor                         = 0;
+  bool reload                            = false;
+  g_autoptr(girara_list_t) inputs = girara_input_history_io_read_since(GIRARA_INPUT_HISTORY_IO(io), &cursor, &reload);
+  g_assert_cmpuint(girara_list_size(inputs), ==, 5);
+
+  /* duplicates and inputs beyond max-entries are removed */
+  g_object_set(io, "max-entries", 3, NULL);
+  GAsyncResult* result = NULL;
+  girara_input_history_file_io_compact_async(io, NULL, test_io_async_done, &result);
+  while (result == NULL) {
+    g_main_context_iteration(NULL, TRUE);
+  }
+  g_assert_true(girara_input_history_file_io_compact_finish(io, result, NULL));
+  g_clear_object(&result);
+  assert_file(path, ":open a\n:open c\n:quit\n");
+
+  /* cursors into the old file are no longer valid */
+  g_autoptr(girara_list_t) reloaded =
+      girara_input_history_io_read_since(GIRARA_INPUT_HISTORY_IO(io), &cursor, &reload);
+  g_assert_true(reload);
+  g_assert_cmpuint(girara_list_size(reloaded), ==, 3);
+
+  /* evicted inputs are removed once they make up half of the file */
+  g_object_set(io, "max-entries", 0, NULL);
+  GiraraInputHistory* history = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  g_object_set(history, "max-entries", 2, NULL);
+  girara_input_history_append(history, ":open d");
+  const gint64 deadline     = g_get_monotonic_time() + 10 * G_TIME_SPAN_SECOND;
+  g_autofree char* contents = NULL;
+  while (g_file_get_contents(path, &contents, NULL, NULL) == FALSE ||
+         g_strcmp0(contents, ":quit\n:open d\n") != 0) {
+    g_clear_pointer(&contents, g_free);
+    g_assert_cmpint(g_get_monotonic_time(), <, deadline);
+    if (g_main_context_iteration(NULL, FALSE) == FALSE) {
+      g_usleep(1000);
+    }
+  }
+
+  girara_input_history_reset(history);
+  static const char* const compacted[] = {":quit", ":open d"};
+  assert_history(history, compacted, G_N_ELEMENTS(compacted));
+  g_object_unref(history);
+
+  file_io_remove(path);
+}
+
+static void assert_search(GiraraInputHistory* history, const char* query, size_t max_results,
+                          const char* const* expected, size_t size) {
+  g_autoptr(girara_list_t) list = girara_input_history_search(history, query, max_results);
+  g_assert_nonnull(list);
+  g_assert_cmpuint(girara_list_size(list), ==, size);
+
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_assert_cmpstr(girara_list_nth(list, idx), ==, expected[idx]);
+  }
+}
+
+static void test_input_history_search(void) {
+  static const char* const inputs[] = {":set zoom 100", ":open /tmp/foo.pdf", ":open /home/user/bar.pdf", ":bmark foo",
+                                       ":quit"};
+  GiraraInputHistory* history       = girara_input_history_new(NULL);
+  for (size_t idx = 0; idx != G_N_ELEMENTS(inputs); ++idx) {
+    girara_input_history_append(history, inputs[idx]);
+  }
+
+  /* matches at the start of words rank higher */
+  static const char* const foo[] = {":bmark foo", ":open /tmp/foo.pdf"};
+  assert_search(history, "foo", 0, foo, G_N_ELEMENTS(foo));
+
+  /* characters do not need to be next to each other, but gaps cost */
+  static const char* const pdf[] = {":open /tmp/foo.pdf", ":open /home/user/bar.pdf"};
+  assert_search(history, "opdf", 0, pdf, G_N_ELEMENTS(pdf));
+  assert_search(history, "fdp", 0, NULL, 0);
+
+  /* only queries with upper case letters are case sensitive */
+  static const char* const quit[] = {":quit"};
+  assert_search(history, "QUIT", 0, NULL, 0);
+  assert_search(history, "quit", 0, quit, G_N_ELEMENTS(quit));
+  assert_search(history, ":Quit", 0, NULL, 0);
+
+  /* ties go to the more recent input */
+  static const char* const recent[] = {":quit", ":bmark foo"};
+  assert_search(history, "", 2, recent, G_N_ELEMENTS(recent));
+
+  /* moved inputs are found once */
+  girara_input_history_append(history, ":open /tmp/foo.pdf");
+  static const char* const moved[] = {":open /tmp/foo.pdf", ":quit"};
+  assert_search(history, "", 2, moved, G_N_ELEMENTS(moved));
+
+  /* evicting inputs wraps the stored inputs around */
+  g_object_set(history, "max-entries", 3, NULL);
+  for (size_t idx = 0; idx != 20; ++idx) {
+    g_autofree char* input = g_strdup_printf(":open %zu", idx);
+    girara_input_history_append(history, input);
+  }
+  static const char* const wrapped[] = {":open 19", ":open 18", ":open 17"};
+  assert_search(history, "open", 0, wrapped, G_N_ELEMENTS(wrapped));
+
+  g_object_unref(history);
+}
+
+static const char* const search_words[] = {"report", "paper",   "notes",  "thesis",
+                                           "manual", "invoice", "slides", "draft"};
+
+/* History of varied inputs for searching */
+static GiraraInputHistory* search_history_new(size_t size) {
+  GiraraInputHistory* history = girara_input_history_new(NULL);
+  for (size_t idx = 0; idx != size; ++idx) {
+    const char* word       = search_words[g_test_rand_int_range(0, G_N_ELEMENTS(search_words))];
+    g_autofree char* input = NULL;
+    switch (idx % 4) {
+    case 0:
+      input = g_strdup_printf(":open ~/documents/%s-%zu.pdf", word, idx);
+      break;
+    case 1:
+      input = g_strdup_printf(":bmark %s %zu", word, idx);
+      break;
+    case 2:
+      input = g_strdup_printf(":set zoom %zu", idx);
+      break;
+    default:
+      input = g_strdup_printf(":exec xdg-open https://example.org/%s/%zu", word, idx);
+      break;
+    }
+    girara_input_history_append(history, input);
+  }
+
+  return history;
+}
+
+static void test_input_history_search_parallel(void) {
+  GiraraInputHistory* history = search_history_new(200000);
+
+  /* searching the prefix index for a few results and scanning all inputs for
+   * all results rank alike */
+  static const char* const queries[] = {"paper", "opn rep", "Zoom", "zoom 99", "xdgthesis", "7"};
+  for (size_t idx = 0; idx != G_N_ELEMENTS(queries); ++idx) {
+    g_autoptr(girara_list_t) all = girara_input_history_search(history, queries[idx], 0);
+    for (size_t max_results = 0; max_results <= 100; max_results += 20) {
+      g_autoptr(girara_list_t) single   = girara_input_history_search(history, queries[idx], max_results);
+      g_autoptr(girara_list_t) parallel = girara_input_history_search_parallel(history, queries[idx], max_results, 4);
+      g_assert_cmpuint(girara_list_size(single), ==, girara_list_size(parallel));
+      g_assert_cmpuint(girara_list_size(single), ==,
+                       max_results != 0 ? MIN(max_results, girara_list_size(all)) : girara_list_size(all));
+      for (size_t result = 0; result != girara_list_size(single); ++result) {
+        g_assert_cmpstr(girara_list_nth(single, result), ==, girara_list_nth(parallel, result));
+        g_assert_cmpstr(girara_list_nth(single, result), ==, girara_list_nth(all, result));
+      }
+    }
+  }
+
+  g_object_unref(history);
+}
+
+static void assert_same_results(girara_list_t* expected, girara_list_t* actual) {
+  g_assert_cmpuint(girara_list_size(actual), ==, girara_list_size(expected));
+  for (size_t idx = 0; idx != girara_list_size(expected); ++idx) {
+    g_assert_cmpstr(girara_list_nth(actual, idx), ==, girara_list_nth(expected, idx));
+  }
+}
+
+static void test_input_history_search_session(void) {
+  GiraraInputHistory* history = search_history_new(20000);
+  g_object_set(history, "max-entries", 15000, NULL);
+  g_autoptr(GiraraInputHistorySearchSession) session = girara_input_history_search_session_new(history);
+
+  /* copies of the boxed session share it */
+  GiraraInputHistorySearchSession* copy = g_boxed_copy(GIRARA_TYPE_INPUT_HISTORY_SEARCH_SESSION, session);
+  g_assert_true(copy == session);
+  g_boxed_free(GIRARA_TYPE_INPUT_HISTORY_SEARCH_SESSION, copy);
+
+  /* typing, removing and replacing characters, and changing the history in
+   * between, gives the same results as searching from scratch */
+  static const char* const queries[] = {"o",       "op",      "ope",    "open",  "open ", "open t", "open th",
+                                        "open t",  "open ",   "open p", "open",  "op",    "o",      "",
+                                        "x",       "xd",      "xdg",    "xdgP",  "xdgp",  "xd",     "zoom",
+                                        "zoom 1",  "zoom 19", "zoom 1", "zoom",  "Zoom",  ""};
+  for (size_t idx = 0; idx != G_N_ELEMENTS(queries); ++idx) {
+    if (idx % 8 == 7) {
+      girara_input_history_append(history, ":open ~/documents/thesis-final.pdf");
+    }
+
+    g_autoptr(girara_list_t) all = girara_input_history_search(history, queries[idx], 0);
+    for (size_t max_results = 0; max_results <= 10; max_results += 10) {
+      g_autoptr(girara_list_t) expected = girara_input_history_search(history, queries[idx], max_results);
+      g_autoptr(girara_list_t) actual = girara_input_history_search_session_update(session, queries[idx], max_results);
+      assert_same_results(expected, actual);
+      for (size_t result = 0; result != girara_list_size(expected); ++result) {
+        g_assert_cmpstr(girara_list_nth(expected, result), ==, girara_list_nth(all, result));
+      }
+    }
+  }
+
+  g_object_unref(history);
+}
+
+/* Number of processes writing to a shared history, and inputs per process */
+#define SHARED_WRITERS 4
+#define SHARED_INPUTS 250
+
+static const char* test_program = NULL;
+
+/* Runs in a separate process. The first writer rewrites the file halfway. */
+static int write_shared_history(const char* path, const char* writer) {
+  g_autoptr(GiraraInputHistoryFileIO) io = girara_input_history_file_io_new_shared(path);
+  for (size_t idx = 0; idx != SHARED_INPUTS; ++idx) {
+    g_autofree char* input = g_strdup_printf(":open writer %s input %zu", writer, idx);
+    girara_input_history_io_append(GIRARA_INPUT_HISTORY_IO(io), input);
+
+    if (idx == SHARED_INPUTS / 2 && g_strcmp0(writer, "0") == 0) {
+      GAsyncResult* result = NULL;
+      girara_input_history_file_io_compact_async(io, NULL, test_io_async_done, &result);
+      while (result == NULL) {
+        g_main_context_iteration(NULL, TRUE);
+      }
+      g_autoptr(GError) error = NULL;
+      if (girara_input_history_file_io_compact_finish(io, result, &error) == false) {
+        g_printerr("%s\n", error->message);
+        return 1;
+      }
+      g_object_unref(result);
+    }
+  }
+
+  return 0;
+}
+
+static void test_io_changed(GiraraInputHistoryIO* GIRARA_UNUSED(io), gpointer data) {
+  ++*(size_t*)data;
+}
+
+static void test_input_history_file_io_shared(void) {
+  g_autofree char* path = file_io_path();
+
+  g_autoptr(GiraraInputHistoryFileIO) io = girara_input_history_file_io_new_shared(path);
+  GiraraInputHistory* history            = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  assert_history(history, NULL, 0);
+
+  GSubprocess* writers[SHARED_WRITERS];
+  for (size_t idx = 0; idx != SHARED_WRITERS; ++idx) {
+    g_autofree char* writer = g_strdup_printf("%zu", idx);
+    writers[idx] = g_subprocess_new(G_SUBPROCESS_FLAGS_NONE, NULL, test_program, "--write-shared-history", path, writer,
+                                    NULL);
+    g_assert_nonnull(writers[idx]);
+  }
+  for (size_t idx = 0; idx != SHARED_WRITERS; ++idx) {
+    g_assert_true(g_subprocess_wait_check(writers[idx], NULL, NULL));
+    g_object_unref(writers[idx]);
+  }
+
+  /* every input was written exactly once and no line was torn */
+  g_autoptr(GHashTable) expected = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  for (size_t writer = 0; writer != SHARED_WRITERS; ++writer) {
+    for (size_t idx = 0; idx != SHARED_INPUTS; ++idx) {
+      g_hash_table_add(expected, g_strdup_printf(":open writer %zu input %zu", writer, idx));
+    }
+  }
+
+  g_autofree char* contents = NULL;
+  g_assert_true(g_file_get_contents(path, &contents, NULL, NULL));
+  g_auto(GStrv) lines = g_strsplit(contents, "\n", -1);
+  g_assert_cmpuint(g_strv_length(lines), ==, SHARED_WRITERS * SHARED_INPUTS + 1);
+  g_autoptr(GHashTable) written = g_hash_table_new(g_str_hash, g_str_equal);
+  for (size_t idx = 0; idx != SHARED_WRITERS * SHARED_INPUTS; ++idx) {
+    g_assert_true(g_hash_table_contains(expected, lines[idx]));
+    g_assert_true(g_hash_table_add(written, lines[idx]));
+  }
+
+  /* the history picks up the inputs of the other processes on its own */
+  const gint64 deadline = g_get_monotonic_time() + 10 * G_TIME_SPAN_SECOND;
+  while (girara_list_size(girara_input_history_list(history)) != SHARED_WRITERS * SHARED_INPUTS) {
+    g_assert_cmpint(g_get_monotonic_time(), <, deadline);
+    if (g_main_context_iteration(NULL, FALSE) == FALSE) {
+      g_usleep(1000);
+    }
+  }
+  girara_list_t* list = girara_input_history_list(history);
+  for (size_t idx = 0; idx != girara_list_size(list); ++idx) {
+    g_assert_true(g_hash_table_contains(expected, girara_list_nth(list, idx)));
+  }
+
+  /* own appends are not reported as changes, those of others are */
+  size_t changes = 0;
+  g_signal_connect(io, "changed", G_CALLBACK(test_io_changed), &changes);
+  girara_input_history_append(history, ":quit");
+  const gint64 quiet = g_get_monotonic_time() + G_TIME_SPAN_SECOND / 2;
+  while (g_get_monotonic_time() < quiet) {
+    if (g_main_context_iteration(NULL, FALSE) == FALSE) {
+      g_usleep(1000);
+    }
+  }
+  g_assert_cmpuint(changes, ==, 0);
+
+  FILE* file = fopen(path, "a");
+  fputs(":open other\n", file);
+  fclose(file);
+  const gint64 changed = g_get_monotonic_time() + 10 * G_TIME_SPAN_SECOND;
+  while (changes == 0) {
+    g_assert_cmpint(g_get_monotonic_time(), <, changed);
+    if (g_main_context_iteration(NULL, FALSE) == FALSE) {
+      g_usleep(1000);
+    }
+  }
+  g_signal_handlers_disconnect_by_data(io, &changes);
+  g_object_unref(history);
+
+  file_io_remove(path);
+}
+
+static void test_input_history_max_entries(void) {
+  static const char* const stored[] = {":open a", ":open b", ":open c"};
+  TestHistoryIO* io                 = test_history_io_new(stored, G_N_ELEMENTS(stored));
+
+  GiraraInputHistory* history = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(io));
+  g_object_set(history, "max-entries", 2, NULL);
+  static const char* const limited[] = {":open b", ":open c"};
+  assert_history(history, limited, G_N_ELEMENTS(limited));
+  g_assert_cmpuint(girara_list_size(io->evicted), ==, 1);
+  g_assert_cmpstr(girara_list_nth(io->evicted, 0), ==, ":open a");
+
+  /* moving an input does not evict anything */
+  girara_input_history_append(history, ":open b");
+  static const char* const moved[] = {":open c", ":open b"};
+  assert_history(history, moved, G_N_ELEMENTS(moved));
+  g_assert_cmpuint(girara_list_size(io->evicted), ==, 1);
+
+  /* a list that is still held does not point to evicted inputs */
+  girara_list_t* held = girara_input_history_list(history);
+  girara_input_history_append(history, ":quit");
+  g_assert_cmpuint(girara_list_size(held), ==, 0);
+  static const char* const appended[] = {":open b", ":quit"};
+  assert_history(history, appended, G_N_ELEMENTS(appended));
+  g_assert_cmpuint(girara_list_size(io->evicted), ==, 2);
+  g_assert_cmpstr(girara_list_nth(io->evicted, 1), ==, ":open c");
+
+  /* evicted inputs are not visited */
+  g_assert_cmpstr(girara_input_history_previous(history, ":open"), ==, ":open b");
+  g_assert_null(girara_input_history_previous(history, ":open b"));
+
+  guint max_entries = 0;
+  g_object_get(history, "max-entries", &max_entries, NULL);
+  g_assert_cmpuint(max_entries, ==, 2);
+  g_object_set(history, "max-entries", 0, NULL);
+  girara_input_history_append(history, ":open a");
+  static const char* const unlimited[] = {":open b", ":quit", ":open a"};
+  assert_history(history, unlimited, G_N_ELEMENTS(unlimited));
+
+  g_object_unref(history);
+  g_object_unref(io);
+}
+
+static void test_input_history_max_entries_random(void) {
+  static const guint max_entries = 8;
+
+  GiraraInputHistory* history = girara_input_history_new(NULL);
+  g_object_set(history, "max-entries", max_entries, NULL);
+  g_autoptr(GPtrArray) expected = g_ptr_array_new_with_free_func(g_free);
+
+  /* wrap around the ring buffer many times while moving and evicting inputs */
+  for (size_t round = 0; round != 10000; ++round) {
+    g_autofree char* input = g_strdup_printf(":open %d", g_test_rand_int_range(0, 16));
+    girara_input_history_append(history, input);
+
+    for (size_t idx = 0; idx != expected->len; ++idx) {
+      if (g_strcmp0(g_ptr_array_index(expected, idx), input) == 0) {
+        g_ptr_array_remove_index(expected, idx);
+        break;
+      }
+    }
+    g_ptr_array_add(expected, g_strdup(input));
+    if (expected->len > max_entries) {
+      g_ptr_array_remove_index(expected, 0);
+    }
+
+    assert_history(history, (const char* const*)expected->pdata, expected->len);
+    if (round % 100 == 0) {
+      girara_input_history_reset(history);
+      for (size_t idx = expected->len; idx != 0; --idx) {
+        g_assert_cmpstr(girara_input_history_previous(history, ""), ==, g_ptr_array_index(expected, idx - 1));
+      }
+      g_assert_null(girara_input_history_previous(history, ""));
+
+      /* walk the inputs starting with a prefix back and forth */
+      girara_input_history_reset(history);
+      g_autoptr(GPtrArray) matches = g_ptr_array_new();
+      for (size_t idx = expected->len; idx != 0; --idx) {
+        if (g_str_has_prefix(g_ptr_array_index(expected, idx - 1), ":open 1") == TRUE) {
+          g_ptr_array_add(matches, g_ptr_array_index(expected, idx - 1));
+        }
+      }
+      for (size_t idx = 0; idx != matches->len; ++idx) {
+        g_assert_cmpstr(girara_input_history_previous(history, ":open 1"), ==, g_ptr_array_index(matches, idx));
+      }
+      g_assert_null(girara_input_history_previous(history, ":open 1"));
+      for (size_t idx = matches->len; idx > 1; --idx) {
+        g_assert_cmpstr(girara_input_history_next(history, ":open 1"), ==, g_ptr_array_index(matches, idx - 2));
+      }
+      g_assert_cmpstr(girara_input_history_next(history, ":open 1"), ==, ":open 1");
+    }
+  }
+
+  g_object_unref(history);
+}
+
+static void test_input_history_append_benchmark(void) {
+  static const size_t size = 100000;
+
+  GiraraInputHistory* history = girara_input_history_new(NULL);
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_autofree char* input = g_strdup_printf(":open /home/user/documents/%06zu.pdf", idx);
+    girara_input_history_append(history, input);
+  }
+
+  /* half of the commands are already in the history */
+  g_test_timer_start();
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_autofree char* input = g_strdup_printf(":open /home/user/documents/%06zu.pdf", idx * 2);
+    girara_input_history_append(history, input);
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "appending 10^5 inputs to a history of 10^5 inputs: %.3fs",
+                          g_test_timer_elapsed());
+  g_assert_cmpuint(girara_list_size(girara_input_history_list(history)), ==, size + size / 2);
+
+  g_object_unref(history);
+}
+
+static void test_input_history_max_entries_benchmark(void) {
+  static const size_t size = 1000000;
+
+  GiraraInputHistory* history = girara_input_history_new(NULL);
+  g_object_set(history, "max-entries", 1000, NULL);
+
+  g_test_timer_start();
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_autofree char* input = g_strdup_printf(":open /home/user/documents/%07zu.pdf", idx);
+    girara_input_history_append(history, input);
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "appending 10^6 inputs to a history of at most 10^3 inputs: %.3fs",
+                          g_test_timer_elapsed());
+  g_assert_cmpuint(girara_list_size(girara_input_history_list(history)), ==, 1000);
+
+  g_object_unref(history);
+}
+
+static void test_input_history_file_io_append_benchmark(void) {
+  static const size_t size = 100000;
+  g_autofree char* path    = file_io_path();
+
+  g_autoptr(GiraraInputHistoryFileIO) io = girara_input_history_file_io_new(path);
+  g_autoptr(GPtrArray) inputs            = g_ptr_array_new_with_free_func(g_free);
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_ptr_array_add(inputs, g_strdup_printf(":open /home/user/documents/%06zu.pdf", idx));
+  }
+
+  g_test_timer_start();
+  for (size_t idx = 0; idx != size; ++idx) {
+    girara_input_history_io_append(GIRARA_INPUT_HISTORY_IO(io), g_ptr_array_index(inputs, idx));
+  }
+  const double elapsed = g_test_timer_elapsed();
+  g_test_minimized_result(elapsed, "appending 10^5 inputs to a history file: %.3fs (%.2fus per input)", elapsed,
+                          elapsed * 1e6 / size);
+
+  file_io_remove(path);
+}
+
+static void test_input_history_file_io_load_benchmark(void) {
+  static const size_t size = 1000000;
+  g_autofree char* path    = file_io_path();
+
+  /* every input occurs twice */
+  g_autoptr(GString) contents = g_string_new(NULL);
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_string_append_printf(contents, ":open /home/user/documents/%06zu.pdf\n", idx % (size / 2));
+  }
+  g_assert_true(g_file_set_contents(path, contents->str, contents->len, NULL));
+
+  g_autoptr(GiraraInputHistoryFileIO) io = girara_input_history_file_io_new(path);
+  g_test_timer_start();
+  g_autoptr(girara_list_t) inputs = girara_input_history_io_read(GIRARA_INPUT_HISTORY_IO(io));
+  g_test_minimized_result(g_test_timer_elapsed(), "reading a history file of 10^6 lines: %.3fs",
+                          g_test_timer_elapsed());
+  g_assert_cmpuint(girara_list_size(inputs), ==, size);
+
+  g_autoptr(GiraraInputHistoryFileIO) other = girara_input_history_file_io_new(path);
+  g_test_timer_start();
+  GiraraInputHistory* history = girara_input_history_new(GIRARA_INPUT_HISTORY_IO(other));
+  g_test_minimized_result(g_test_timer_elapsed(), "loading a history of 10^6 lines: %.3fs", g_test_timer_elapsed());
+  g_assert_cmpuint(girara_list_size(girara_input_history_list(history)), ==, size / 2);
+  g_object_unref(history);
+
+  file_io_remove(path);
+}
+
+static void test_input_history_search_benchmark(void) {
+  static const char query[]   = "open thesis";
+  GiraraInputHistory* history = search_history_new(1000000);
+
+  for (unsigned int n_threads = 1; n_threads <= 4; n_threads *= 2) {
+    /* search once per keystroke */
+    double slowest = 0;
+    g_test_timer_start();
+    for (size_t length = 1; length <= strlen(query); ++length) {
+      g_autofree char* typed = g_strndup(query, length);
+      const double start     = g_test_timer_elapsed();
+      girara_list_free(girara_input_history_search_parallel(history, typed, 20, n_threads));
+      slowest = MAX(slowest, g_test_timer_elapsed() - start);
+    }
+    g_test_minimized_result(slowest, "slowest of %zu searches in 10^6 inputs using %u threads: %.1fms", strlen(query),
+                            n_threads, slowest * 1000);
+  }
+
+  g_object_unref(history);
+}
+
+static void test_input_history_search_session_benchmark(void) {
+  static const char query[]   = "thesis-424";
+  GiraraInputHistory* history = search_history_new(1000000);
+
+  g_test_timer_start();
+  for (size_t length = 1; length <= strlen(query); ++length) {
+    g_autofree char* typed = g_strndup(query, length);
+    girara_list_free(girara_input_history_search(history, typed, 20));
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "typing a %zu character query searching 10^6 inputs: %.3fs",
+                          strlen(query), g_test_timer_elapsed());
+
+  g_autoptr(GiraraInputHistorySearchSession) session = girara_input_history_search_session_new(history);
+  g_test_timer_start();
+  for (size_t length = 1; length <= strlen(query); ++length) {
+    g_autofree char* typed = g_strndup(query, length);
+    girara_list_free(girara_input_history_search_session_update(session, typed, 20));
+  }
+  g_test_minimized_result(g_test_timer_elapsed(),
+                          "typing a %zu character query in a search session over 10^6 inputs: %.3fs", strlen(query),
+                          g_test_timer_elapsed());
+
+  g_object_unref(history);
+}
+
+static void test_input_history_navigate_benchmark(void) {
+  static const size_t size = 100000;
+
+  /* one in every thousand inputs matches */
+  GiraraInputHistory* history = girara_input_history_new(NULL);
+  for (size_t idx = 0; idx != size; ++idx) {
+    g_autofree char* input = idx % 1000 == 0 ? g_strdup_printf(":set zoom %zu", idx)
+                                             : g_strdup_printf(":open /home/user/documents/%06zu.pdf", idx);
+    girara_input_history_append(history, input);
+  }
+
+  g_test_timer_start();
+  for (size_t round = 0; round != 100; ++round) {
+    girara_input_history_reset(history);
+    size_t matches = 0;
+    while (girara_input_history_previous(history, ":set") != NULL) {
+      ++matches;
+    }
+    g_assert_cmpuint(matches, ==, size / 1000);
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "visiting 10^2 matches in a history of 10^5 inputs 10^2 times: %.3fs",
+                          g_test_timer_elapsed());
+
+  /* nearly all inputs match a short prefix */
+  g_test_timer_start();
+  for (size_t round = 0; round != 100; ++round) {
+    girara_input_history_reset(history);
+    g_assert_cmpstr(girara_input_history_previous(history, ":"), ==, ":open /home/user/documents/099999.pdf");
+    g_assert_cmpstr(girara_input_history_previous(history, ":"), ==, ":open /home/user/documents/099998.pdf");
+  }
+  g_test_minimized_result(g_test_timer_elapsed(), "visiting 2 of 10^5 matches 10^2 times: %.3fs",
+                          g_test_timer_elapsed());
+
+  g_object_unref(history);
+}
+
+int main(int argc, char* argv[]) {
+  if (argc == 4 && g_strcmp0(argv[1], "--write-shared-history") == 0) {
+    return write_shared_history(argv[2], argv[3]);
+  }
+
+  test_program = argv[0];
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_func("/input_history/append", test_input_history_append);
+  g_test_add_func("/input_history/io", test_input_history_io);
+  g_test_add_func("/input_history/io_incremental", test_input_history_io_incremental);
+  g_test_add_func("/input_history/io_async", test_input_history_io_async);
+  g_test_add_func("/input_history/io_async/fallback", test_input_history_io_async_fallback);
+  g_test_add_func("/input_history/flush", test_input_history_flush);
+  g_test_add_func("/input_history/flush/async", test_input_history_flush_async);
+  g_test_add_func("/input_history/navigate", test_input_history_navigate);
+  g_test_add_func("/input_history/navigate_moved", test_input_history_navigate_moved);
+  g_test_add_func("/input_history/navigate_overridden", test_input_history_navigate_overridden);
+  g_test_add_func("/input_history/navigate_read", test_input_history_navigate_read);
+  g_test_add_func("/input_history/search", test_input_history_search);
+  g_test_add_func("/input_history/search/parallel", test_input_history_search_parallel);
+  g_test_add_func("/input_history/search/session", test_input_history_search_session);
+  g_test_add_func("/input_history/file_io", test_input_history_file_io);
+  g_test_add_func("/input_history/file_io/compact", test_input_history_file_io_compact);
+  g_test_add_func("/input_history/file_io/shared", test_input_history_file_io_shared);
+  g_test_add_func("/input_history/max_entries", test_input_history_max_entries);
+  g_test_add_func("/input_history/max_entries/random", test_input_history_max_entries_random);
+
+  if (g_test_perf()) {
+    g_test_add_func("/input_history/append/benchmark", test_input_history_append_benchmark);
+    g_test_add_func("/input_history/file_io/append/benchmark", test_input_history_file_io_append_benchmark);
+    g_test_add_func("/input_history/file_io/load/benchmark", test_input_history_file_io_load_benchmark);
+    g_test_add_func("/input_history/max_entries/benchmark", test_input_history_max_entries_benchmark);
+    g_test_add_func("/input_history/navigate/benchmark", test_input_history_navigate_benchmark);
+    g_test_add_func("/input_history/search/benchmark", test_input_history_search_benchmark);
+    g_test_add_func("/input_history/search/session/benchmark", test_input_history_search_session_benchmark);
+  }
+
+  return g_test_run();
+}